@@ -0,0 +1,115 @@
+#include "controlLoop.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <iostream>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Constructs a ControlLoop ticking at frequency Hz, starting one period
+// from now. Stats are published on statsChannel every statsInterval
+// seconds.
+ControlLoop::ControlLoop( lcm::LCM& lcmObject, double frequency, double statsInterval, const string& statsChannel )
+    : mLcmObject( lcmObject )
+    , mTimerFd( timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC ) )
+    , mPeriod( static_cast<long>( 1e9 / frequency ) )
+    , mTicksDue( 0 )
+    , mStatsInterval( static_cast<long>( statsInterval * 1e9 ) )
+    , mStatsChannel( statsChannel )
+    , mStats()
+    , mJitterTotalMs( 0 )
+{
+    if( mTimerFd < 0 )
+    {
+        cerr << "Error: cannot create control loop timer\n";
+        return;
+    }
+
+    itimerspec spec;
+    spec.it_interval.tv_sec = mPeriod.count() / 1000000000;
+    spec.it_interval.tv_nsec = mPeriod.count() % 1000000000;
+    spec.it_value = spec.it_interval;
+    mStart = chrono::steady_clock::now() + mPeriod;
+    timerfd_settime( mTimerFd, 0, &spec, nullptr );
+
+    mIntervalStart = chrono::steady_clock::now();
+    mStats.period_ms = mPeriod.count() / 1e6;
+} // ControlLoop()
+
+ControlLoop::~ControlLoop()
+{
+    if( mTimerFd >= 0 )
+    {
+        close( mTimerFd );
+    }
+} // ~ControlLoop()
+
+bool ControlLoop::good() const
+{
+    return mTimerFd >= 0;
+} // good()
+
+// Sleeps until the timer expires. Messages are handled on their own
+// thread meanwhile, so nothing but the timer wakes the control thread.
+bool ControlLoop::waitForTick()
+{
+    pollfd timer;
+    timer.fd = mTimerFd;
+    timer.events = POLLIN;
+
+    while( true )
+    {
+        if( poll( &timer, 1, -1 ) < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            return false;
+        }
+
+        uint64_t expirations = 0;
+        if( read( mTimerFd, &expirations, sizeof( expirations ) ) != sizeof( expirations ) )
+        {
+            continue;
+        }
+
+        // More than one expiration means ticks went by while the last
+        // one was still running.
+        mTicksDue += expirations;
+        mStats.overruns += expirations - 1;
+        mTickStart = chrono::steady_clock::now();
+        auto due = mStart + mPeriod * ( mTicksDue - 1 );
+        double jitterMs = chrono::duration<double, milli>( mTickStart - due ).count();
+        mJitterTotalMs += jitterMs;
+        mStats.jitter_max_ms = max( mStats.jitter_max_ms, jitterMs );
+        return true;
+    }
+} // waitForTick()
+
+void ControlLoop::tickDone()
+{
+    auto now = chrono::steady_clock::now();
+    ++mStats.ticks;
+    mStats.run_max_ms = max( mStats.run_max_ms, chrono::duration<double, milli>( now - mTickStart ).count() );
+
+    if( now - mIntervalStart >= mStatsInterval )
+    {
+        publishStats();
+        mIntervalStart = now;
+    }
+} // tickDone()
+
+// Publishes the stats for the interval and starts a new one.
+void ControlLoop::publishStats()
+{
+    mStats.jitter_mean_ms = mStats.ticks ? mJitterTotalMs / mStats.ticks : 0;
+    mLcmObject.publish( mStatsChannel, &mStats );
+
+    double periodMs = mStats.period_ms;
+    mStats = NavTickStats();
+    mStats.period_ms = periodMs;
+    mJitterTotalMs = 0;
+} // publishStats()
@@ -0,0 +1,64 @@
+#ifndef CONTROL_LOOP_HPP
+#define CONTROL_LOOP_HPP
+
+#include <chrono>
+#include <lcm/lcm-cpp.hpp>
+#include <string>
+
+#include "rover_msgs/NavTickStats.hpp"
+
+using namespace rover_msgs;
+using namespace std;
+
+// Runs the nav loop at a fixed rate off a timerfd, so control no longer
+// waits on whichever channel publishes next. Tick timing is published
+// on a stats channel so a slow state machine or an overloaded Jetson
+// shows up as jitter and overruns.
+class ControlLoop
+{
+public:
+    ControlLoop( lcm::LCM& lcmObject, double frequency, double statsInterval, const string& statsChannel );
+
+    ~ControlLoop();
+
+    // False if the timer could not be created.
+    bool good() const;
+
+    // Waits until the next tick is due. Returns false if the timer
+    // fails.
+    bool waitForTick();
+
+    // Marks the end of the work done on this tick and publishes the
+    // stats when an interval has passed.
+    void tickDone();
+
+private:
+    void publishStats();
+
+    // Lcm object for publishing stats.
+    lcm::LCM& mLcmObject;
+
+    // Timer file descriptor, -1 if it could not be created.
+    int mTimerFd;
+
+    // Time between ticks.
+    chrono::nanoseconds mPeriod;
+
+    // When the first tick was due. Tick n is due n periods after.
+    chrono::steady_clock::time_point mStart;
+
+    // Ticks due since the start, including skipped ones.
+    long mTicksDue;
+
+    // When the current tick started running.
+    chrono::steady_clock::time_point mTickStart;
+
+    // Stats over the current interval.
+    chrono::nanoseconds mStatsInterval;
+    string mStatsChannel;
+    chrono::steady_clock::time_point mIntervalStart;
+    NavTickStats mStats;
+    double mJitterTotalMs;
+}; // ControlLoop
+
+#endif // CONTROL_LOOP_HPP
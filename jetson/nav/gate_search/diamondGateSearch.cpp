@@ -5,7 +5,7 @@
 #include <iostream>
 #include <cmath>
 
-DiamondGateSearch::DiamondGateSearch( StateMachine* stateMachine, Rover* rover, const rapidjson::Document& roverConfig )
+DiamondGateSearch::DiamondGateSearch( StateMachine* stateMachine, Rover* rover, const NavConfig& roverConfig )
     : GateStateMachine(stateMachine, rover, roverConfig ) {}
 
 DiamondGateSearch::~DiamondGateSearch() {}
@@ -13,7 +13,8 @@ DiamondGateSearch::~DiamondGateSearch() {}
 void DiamondGateSearch::initializeSearch()
 {
     mGateSearchPoints.clear();
-    Odometry currOdom = mRover->roverStatus().odometry();
+    const LocalPoint& currPosition = mRover->roverStatus().position();
+    const double currBearing = mRover->roverStatus().odometry().bearing_deg;
     double diamondWidth = mRover->roverStatus().path().front().gate_width * 1.5;
     const double targetBearing = mRover->roverStatus().target().bearing;
     const double targetDist = mRover->roverStatus().target().distance;
@@ -22,18 +23,18 @@ void DiamondGateSearch::initializeSearch()
     double distance = sqrt(pow(targetDist, 2) + pow(diamondWidth, 2));
     double theta = atan2(diamondWidth, targetDist) * 180 / PI;
     double relTurn = theta + targetBearing;
-    double angle = mod(currOdom.bearing_deg + relTurn, 360); // absolute bearing
+    double angle = mod(currBearing + relTurn, 360); // absolute bearing
 
-    Odometry corner1 = createOdom(currOdom, angle, distance, mRover);
+    LocalPoint corner1 = createPoint(currPosition, angle, distance);
 
-    const double absolute_bear_to_target = mod(currOdom.bearing_deg + targetBearing, 360);
-    Odometry corner2 = createOdom(currOdom, absolute_bear_to_target, diamondWidth + targetDist, mRover);
+    const double absolute_bear_to_target = mod(currBearing + targetBearing, 360);
+    LocalPoint corner2 = createPoint(currPosition, absolute_bear_to_target, diamondWidth + targetDist);
 
     relTurn = -1 * theta + targetBearing;
-    angle = mod(currOdom.bearing_deg + relTurn, 360);
-    Odometry corner3 = createOdom(currOdom, angle, distance, mRover);
+    angle = mod(currBearing + relTurn, 360);
+    LocalPoint corner3 = createPoint(currPosition, angle, distance);
 
-    Odometry corner4 = createOdom(currOdom, mod(absolute_bear_to_target + 180, 360), diamondWidth - targetDist, mRover);
+    LocalPoint corner4 = createPoint(currPosition, mod(absolute_bear_to_target + 180, 360), diamondWidth - targetDist);
 
     mGateSearchPoints.push_back(corner1);
     mGateSearchPoints.push_back(corner2);
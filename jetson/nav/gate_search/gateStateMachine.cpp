@@ -7,7 +7,7 @@
 #include <iostream>
 
 // Constructs a GateStateMachine object with roverStateMachine
-GateStateMachine::GateStateMachine( StateMachine* stateMachine, Rover* rover, const rapidjson::Document& roverConfig )
+GateStateMachine::GateStateMachine( StateMachine* stateMachine, Rover* rover, const NavConfig& roverConfig )
     : mRoverStateMachine( stateMachine )
     , mRoverConfig( roverConfig )
     , mRover( rover ) {}
@@ -76,7 +76,7 @@ NavState GateStateMachine::run()
 NavState GateStateMachine::executeGateSpin()
 {
     // degrees to turn to before performing a search wait.
-    double waitStepSize = mRoverConfig[ "search" ][ "searchWaitStepSize" ].GetDouble();
+    double waitStepSize = mRoverConfig.search.searchWaitStepSize;
     static double nextStop = 0; // to force the rover to wait initially
     static double mOriginalSpinAngle = 0; //initialize, is corrected on first call
 
@@ -111,7 +111,7 @@ NavState GateStateMachine::executeGateSpin()
 NavState GateStateMachine::executeGateSpinWait()
 {
     static bool started = false;
-    static time_t startTime;
+    static double startTime;
 
     if( mRover->roverStatus().target2().distance >= 0 ||
         ( mRover->roverStatus().target().distance >= 0 && mRover->roverStatus().target().id != lastKnownPost1.id ))
@@ -124,11 +124,11 @@ NavState GateStateMachine::executeGateSpinWait()
     if( !started )
     {
         mRover->stop();
-        startTime = time( nullptr );
+        startTime = navTime();
         started = true;
     }
-    double waitTime = mRoverConfig[ "search" ][ "searchWaitTime" ].GetDouble();
-    if( difftime( time( nullptr ), startTime ) > waitTime )
+    double waitTime = mRoverConfig.search.searchWaitTime;
+    if( navTime() - startTime > waitTime )
     {
         started = false;
         return NavState::GateSpin;
@@ -152,7 +152,7 @@ NavState GateStateMachine::executeGateTurn()
         return NavState::GateTurnToCentPoint;
     }
 
-    Odometry& nextSearchPoint = mGateSearchPoints.front();
+    const LocalPoint& nextSearchPoint = mGateSearchPoints.front();
     if( mRover->turn( nextSearchPoint ) )
     {
         return NavState::GateDrive;
@@ -178,7 +178,7 @@ NavState GateStateMachine::executeGateDrive()
     //     roverStateMachine->updateObstacleDistance( rover->roverStatus().obstacle().distance );
     //     return NavState::SearchTurnAroundObs;
     // }
-    const Odometry& nextSearchPoint = mGateSearchPoints.front();
+    const LocalPoint& nextSearchPoint = mGateSearchPoints.front();
     DriveStatus driveStatus = mRover->drive( nextSearchPoint );
 
     if( driveStatus == DriveStatus::Arrived )
@@ -230,14 +230,14 @@ NavState GateStateMachine::executeGateFace()
 NavState GateStateMachine::executeGateShimmy()
 {
     static int direction = 1; // 1 = forward, -1 = backwards
-    const double fovDepth = mRoverConfig["computerVision"]["visionDistance"].GetDouble();
-    const double fovAngle = mRoverConfig["computerVision"]["fieldOfViewSafeAngle"].GetDouble();
-    const Odometry currOdom = mRover->roverStatus().odometry();
+    const double fovDepth = mRoverConfig.computerVision.visionDistance;
+    const double fovAngle = mRoverConfig.computerVision.fieldOfViewSafeAngle;
+    const LocalPoint currPosition = mRover->roverStatus().position();
 
     // If we are centered
     const double targetAnglesDiff = mRover->roverStatus().target().bearing +
                                     mRover->roverStatus().target2().bearing;
-    if(targetAnglesDiff < mRoverConfig["navThresholds"]["gateCenteredAngleDiff"].GetDouble())
+    if(targetAnglesDiff < mRoverConfig.navThresholds.gateCenteredAngleDiff)
     {
         direction = 1;
         return NavState::GateDriveThrough;
@@ -257,9 +257,9 @@ NavState GateStateMachine::executeGateShimmy()
 
     // Otherwise keep driving
     const double gateWidth = mRover->roverStatus().path().front().gate_width;
-    const double gateAngle = calcBearing(lastKnownPost1.odom, lastKnownPost2.odom); // Angle from post 1 to post 2
-    const Odometry gateCent = createOdom(lastKnownPost1.odom, gateAngle, gateWidth / 2, mRover);
-    const double roverToGateCentAngle = calcBearing(currOdom, gateCent); // ablsolute angle
+    const double gateAngle = calcBearing(lastKnownPost1.position, lastKnownPost2.position); // Angle from post 1 to post 2
+    const LocalPoint gateCent = createPoint(lastKnownPost1.position, gateAngle, gateWidth / 2);
+    const double roverToGateCentAngle = calcBearing(currPosition, gateCent); // ablsolute angle
     mRover->drive(direction, roverToGateCentAngle); // TODO: drive straight when going backwards
     return NavState::GateShimmy;
 } // executeGateShimmy()
@@ -273,7 +273,7 @@ NavState GateStateMachine::executeGateDriveThrough()
     {
         if(!CP1ToCP2CorrectDir)
         {
-            const Odometry temp = centerPoint1;
+            const LocalPoint temp = centerPoint1;
             centerPoint1 = centerPoint2;
             centerPoint2 = temp;
             CP1ToCP2CorrectDir = true;
@@ -299,10 +299,9 @@ void GateStateMachine::updatePost2Info()
         const double targetAbsAngle = mod(mRover->roverStatus().odometry().bearing_deg +
                                           mRover->roverStatus().target2().bearing,
                                           360);
-        lastKnownPost2.odom = createOdom( mRover->roverStatus().odometry(),
-                                          targetAbsAngle,
-                                          mRover->roverStatus().target2().distance,
-                                          mRover );
+        lastKnownPost2.position = createPoint( mRover->roverStatus().position(),
+                                               targetAbsAngle,
+                                               mRover->roverStatus().target2().distance );
         lastKnownPost2.id = mRover->roverStatus().target2().id;
     }
     else
@@ -310,10 +309,9 @@ void GateStateMachine::updatePost2Info()
         const double targetAbsAngle = mod(mRover->roverStatus().odometry().bearing_deg +
                                           mRover->roverStatus().target().bearing,
                                           360);
-        lastKnownPost2.odom = createOdom( mRover->roverStatus().odometry(),
-                                          targetAbsAngle,
-                                          mRover->roverStatus().target().distance,
-                                          mRover );
+        lastKnownPost2.position = createPoint( mRover->roverStatus().position(),
+                                               targetAbsAngle,
+                                               mRover->roverStatus().target().distance );
         lastKnownPost2.id = mRover->roverStatus().target().id;
     }
 } // updatePost2Info()
@@ -324,21 +322,21 @@ void GateStateMachine::updatePost2Info()
 // through it in the correct direction.
 void GateStateMachine::calcCenterPoint()
 {
-    const Odometry& currOdom = mRover->roverStatus().odometry();
+    const LocalPoint& currPosition = mRover->roverStatus().position();
     const double distFromGate = 3;
     const double gateWidth = mRover->roverStatus().path().front().gate_width;
     const double tagToPointAngle = radianToDegree(atan2(distFromGate, gateWidth / 2));
-    const double gateAngle = calcBearing(lastKnownPost1.odom, lastKnownPost2.odom);
+    const double gateAngle = calcBearing(lastKnownPost1.position, lastKnownPost2.position);
     const double absAngle1 = mod(gateAngle + tagToPointAngle, 360);
     const double absAngle2 = mod(absAngle1 + 180, 360);
     const double tagToPointDist = sqrt(pow(gateWidth / 2, 2) + pow(distFromGate, 2));
     // Assuming that CV works well enough that we don't pass through the gate before
     // finding the second post. Thus, centerPoint1 will always be closer.
     // TODO: verify this
-    centerPoint1 = createOdom(lastKnownPost1.odom, absAngle1, tagToPointDist, mRover);
-    centerPoint2 = createOdom(lastKnownPost2.odom, absAngle2, tagToPointDist, mRover);
-    const double cp1Dist = estimateNoneuclid(currOdom, centerPoint1);
-    const double cp2Dist = estimateNoneuclid(currOdom, centerPoint2);
+    centerPoint1 = createPoint(lastKnownPost1.position, absAngle1, tagToPointDist);
+    centerPoint2 = createPoint(lastKnownPost2.position, absAngle2, tagToPointDist);
+    const double cp1Dist = calcDistance(currPosition, centerPoint1);
+    const double cp2Dist = calcDistance(currPosition, centerPoint2);
     if(lastKnownPost1.id % 2)
     {
         CP1ToCP2CorrectDir = true;
@@ -349,7 +347,7 @@ void GateStateMachine::calcCenterPoint()
     }
     if(cp1Dist > cp2Dist)
     {
-        const Odometry temp = centerPoint1;
+        const LocalPoint temp = centerPoint1;
         centerPoint1 = centerPoint2;
         centerPoint2 = temp;
         CP1ToCP2CorrectDir = !CP1ToCP2CorrectDir;
@@ -358,7 +356,7 @@ void GateStateMachine::calcCenterPoint()
 } // calcCenterPoint()
 
 // Creates an GateStateMachine object
-GateStateMachine* GateFactory( StateMachine* stateMachine, Rover* rover, const rapidjson::Document& roverConfig )
+GateStateMachine* GateFactory( StateMachine* stateMachine, Rover* rover, const NavConfig& roverConfig )
 {
     return new DiamondGateSearch( stateMachine, rover, roverConfig );
 } // GateFactor()
@@ -4,18 +4,24 @@
 #include <deque>
 
 #include "../rover.hpp"
-#include "rover_msgs/Odometry.hpp"
 // #include "../gate_search/gateStateMachine.hpp"
 
 class StateMachine;
 
+// Where a gate post was last seen, in the local frame, and its id.
+struct GatePost
+{
+    LocalPoint position;
+    int32_t id;
+};
+
 class GateStateMachine
 {
 public:
     /*************************************************************************/
     /* Public Member Functions */
     /*************************************************************************/
-    GateStateMachine( StateMachine* stateMachine, Rover* rover, const rapidjson::Document& roverConfig );
+    GateStateMachine( StateMachine* stateMachine, Rover* rover, const NavConfig& roverConfig );
 
     virtual ~GateStateMachine();
 
@@ -27,13 +33,13 @@ public:
     /* Public Member Variables */
     /*************************************************************************/
     /* saved last known location of first tag of a gate */
-    Waypoint lastKnownPost1;
+    GatePost lastKnownPost1;
 
     /* saved last known location of second tag of a gate */
-    Waypoint lastKnownPost2;
+    GatePost lastKnownPost2;
 
     // Queue of search points
-    deque<Odometry> mGateSearchPoints;
+    deque<LocalPoint> mGateSearchPoints;
 
 private:
     /*************************************************************************/
@@ -68,11 +74,11 @@ private:
     StateMachine* mRoverStateMachine;
 
     // Reference to config variables
-    const rapidjson::Document& mRoverConfig;
+    const NavConfig& mRoverConfig;
 
     // Points in frnot of center of gate
-    Odometry centerPoint1;
-    Odometry centerPoint2;
+    LocalPoint centerPoint1;
+    LocalPoint centerPoint2;
 
     //
     bool CP1ToCP2CorrectDir;
@@ -85,6 +91,6 @@ protected:
     Rover* mRover;
 };
 
-GateStateMachine* GateFactory( StateMachine* stateMachine, Rover* rover, const rapidjson::Document& roverConfig );
+GateStateMachine* GateFactory( StateMachine* stateMachine, Rover* rover, const NavConfig& roverConfig );
 
 #endif //GATE_STATE_MACHINE_HPP
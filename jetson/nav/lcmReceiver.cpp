@@ -0,0 +1,190 @@
+#include "lcmReceiver.hpp"
+
+// Subscribes to every channel nav listens on. Messages are not handled
+// until start is called.
+LcmReceiver::LcmReceiver( lcm::LCM& lcmObject, const string& configChannel )
+    : mLcmObject( lcmObject )
+    , mRunning( false )
+    , mFailed( false )
+    , mHaveCourse( false )
+    , mCourseHash( 0 )
+{
+    mLcmObject.subscribe( "/auton", &LcmReceiver::autonState, this );
+    mLcmObject.subscribe( "/course", &LcmReceiver::course, this );
+    mLcmObject.subscribe( "/obstacle", &LcmReceiver::obstacle, this );
+    mLcmObject.subscribe( "/odometry", &LcmReceiver::odometry, this );
+    mLcmObject.subscribe( "/radio", &LcmReceiver::radioSignalStrength, this );
+    mLcmObject.subscribe( "/rr_drop_complete", &LcmReceiver::repeaterDropComplete, this );
+    mLcmObject.subscribe( "/target_list", &LcmReceiver::targetList, this );
+    mLcmObject.subscribe( configChannel, &LcmReceiver::configReload, this );
+} // LcmReceiver()
+
+LcmReceiver::~LcmReceiver()
+{
+    stop();
+} // ~LcmReceiver()
+
+// Starts handling messages on the receive thread.
+void LcmReceiver::start()
+{
+    mRunning = true;
+    mThread = thread( &LcmReceiver::receive, this );
+} // start()
+
+// Stops the receive thread and waits for it to finish.
+void LcmReceiver::stop()
+{
+    mRunning = false;
+    if( mThread.joinable() )
+    {
+        mThread.join();
+    }
+} // stop()
+
+// Returns true if the receive thread stopped because LCM failed.
+bool LcmReceiver::failed() const
+{
+    return mFailed;
+} // failed()
+
+// Control thread only. Passes every message that arrived since the
+// last call to the state machine. Only the newest message on each
+// channel is passed, and nothing waits on the receive thread.
+void LcmReceiver::deliver( StateMachine& stateMachine )
+{
+    if( const ConfigReload* reload = mConfigReload.fetch() )
+    {
+        stateMachine.reloadConfig( reload->config );
+    }
+    if( const AutonState* autonState = mAutonState.fetch() )
+    {
+        stateMachine.updateRoverStatus( *autonState );
+    }
+    if( const Course* course = mCourse.fetch() )
+    {
+        stateMachine.updateRoverStatus( *course );
+    }
+    if( const Obstacle* obstacle = mObstacle.fetch() )
+    {
+        stateMachine.updateRoverStatus( *obstacle );
+    }
+    if( const Odometry* odometry = mOdometry.fetch() )
+    {
+        stateMachine.updateRoverStatus( *odometry );
+    }
+    if( const TargetList* targetList = mTargetList.fetch() )
+    {
+        stateMachine.updateRoverStatus( *targetList );
+    }
+    if( const RadioSignalStrength* signal = mRadio.fetch() )
+    {
+        stateMachine.updateRoverStatus( *signal );
+    }
+    if( mRepeaterDropComplete.fetch() )
+    {
+        stateMachine.updateRepeaterComplete();
+    }
+} // deliver()
+
+// Handles messages until stopped. The timeout bounds how long stop
+// waits for the thread.
+void LcmReceiver::receive()
+{
+    while( mRunning )
+    {
+        if( mLcmObject.handleTimeout( 100 ) < 0 )
+        {
+            mFailed = true;
+            return;
+        }
+    }
+} // receive()
+
+// Leaves the auton state lcm message for the state machine.
+void LcmReceiver::autonState(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const AutonState* autonState
+    )
+{
+    mAutonState.post( *autonState );
+} // autonState()
+
+// Leaves the course lcm message for the state machine if it is a new
+// course.
+void LcmReceiver::course(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const Course* course
+    )
+{
+    if( mHaveCourse && course->hash == mCourseHash )
+    {
+        return;
+    }
+    mHaveCourse = true;
+    mCourseHash = course->hash;
+    mCourse.post( *course );
+} // course()
+
+// Leaves the obstacle lcm message for the state machine.
+void LcmReceiver::obstacle(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const Obstacle* obstacle
+    )
+{
+    mObstacle.post( *obstacle );
+} // obstacle()
+
+// Leaves the odometry lcm message for the state machine.
+void LcmReceiver::odometry(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const Odometry* odometry
+    )
+{
+    mOdometry.post( *odometry );
+} // odometry()
+
+// Leaves the target lcm message for the state machine.
+void LcmReceiver::targetList(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const TargetList* targetList
+    )
+{
+    mTargetList.post( *targetList );
+} // targetList()
+
+// Leaves the radio lcm message for the state machine.
+void LcmReceiver::radioSignalStrength(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const RadioSignalStrength* signal
+    )
+{
+    mRadio.post( *signal );
+} // radioSignalStrength()
+
+// Tells the state machine a radio repeater was dropped.
+void LcmReceiver::repeaterDropComplete(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const RepeaterDrop* complete
+    )
+{
+    mRepeaterDropComplete.post( *complete );
+} // repeaterDropComplete()
+
+// Leaves a config reload request for the state machine. Reloads are
+// applied on the control thread, which is the only one reading the
+// config.
+void LcmReceiver::configReload(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const ConfigReload* reload
+    )
+{
+    mConfigReload.post( *reload );
+} // configReload()
@@ -0,0 +1,95 @@
+#ifndef LCM_RECEIVER_HPP
+#define LCM_RECEIVER_HPP
+
+#include <atomic>
+#include <lcm/lcm-cpp.hpp>
+#include <string>
+#include <thread>
+
+#include "mailbox.hpp"
+#include "stateMachine.hpp"
+#include "rover_msgs/ConfigReload.hpp"
+
+using namespace rover_msgs;
+using namespace std;
+
+// This class receives all incoming LCM messages for the autonomous
+// navigation of the rover on its own thread. Each channel's latest
+// message is left in a mailbox, and the control thread hands whatever
+// has arrived to the state machine at the start of each tick, so a
+// burst of messages on one channel never holds up control.
+class LcmReceiver
+{
+public:
+    LcmReceiver( lcm::LCM& lcmObject, const string& configChannel );
+
+    ~LcmReceiver();
+
+    void start();
+
+    void stop();
+
+    bool failed() const;
+
+    void deliver( StateMachine& stateMachine );
+
+private:
+    /*************************************************************************/
+    /* Private Member Functions */
+    /*************************************************************************/
+    void receive();
+
+    void autonState( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                     const AutonState* autonState );
+
+    void course( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                 const Course* course );
+
+    void obstacle( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                   const Obstacle* obstacle );
+
+    void odometry( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                   const Odometry* odometry );
+
+    void targetList( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                     const TargetList* targetList );
+
+    void radioSignalStrength( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                              const RadioSignalStrength* signal );
+
+    void repeaterDropComplete( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                               const RepeaterDrop* complete );
+
+    void configReload( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                       const ConfigReload* reload );
+
+    /*************************************************************************/
+    /* Private Member Variables */
+    /*************************************************************************/
+    // Lcm object for receiving messages.
+    lcm::LCM& mLcmObject;
+
+    // The thread that handles LCM, and whether it should keep going.
+    thread mThread;
+    atomic<bool> mRunning;
+
+    // Set by the receive thread if handling LCM fails.
+    atomic<bool> mFailed;
+
+    // The latest message on each channel.
+    Mailbox<AutonState> mAutonState;
+    Mailbox<Course> mCourse;
+    Mailbox<Obstacle> mObstacle;
+    Mailbox<Odometry> mOdometry;
+    Mailbox<TargetList> mTargetList;
+    Mailbox<RadioSignalStrength> mRadio;
+    Mailbox<RepeaterDrop> mRepeaterDropComplete;
+    Mailbox<ConfigReload> mConfigReload;
+
+    // The hash of the last course posted. The course is republished
+    // constantly, so only new courses are copied into the mailbox.
+    bool mHaveCourse;
+    int64_t mCourseHash;
+}; // LcmReceiver
+
+#endif // LCM_RECEIVER_HPP
@@ -0,0 +1,84 @@
+#include "localFrame.hpp"
+
+#include <cmath>
+
+#include "utilities.hpp"
+
+namespace
+{
+    // Returns a latitude or longitude in minutes.
+    double totalMinutes( const int32_t degrees, const double minutes )
+    {
+        return degrees * 60 + minutes;
+    } // totalMinutes()
+
+    // Splits minutes into the whole degrees and minutes Odometry holds.
+    // Both parts share the sign.
+    void splitMinutes( const double totalMin, int32_t& degrees, double& minutes )
+    {
+        degrees = static_cast<int32_t>( trunc( totalMin / 60 ) );
+        minutes = totalMin - degrees * 60;
+    } // splitMinutes()
+} // namespace
+
+// Constructs a waypoint at the local origin.
+LocalWaypoint::LocalWaypoint()
+    : Waypoint()
+    , position{ 0, 0 }
+{
+} // LocalWaypoint()
+
+// Constructs a copy of waypoint at the given local position.
+LocalWaypoint::LocalWaypoint( const Waypoint& waypoint, const LocalPoint& positionIn )
+    : Waypoint( waypoint )
+    , position( positionIn )
+{
+} // LocalWaypoint()
+
+// Constructs a frame anchored at 0 degrees latitude and longitude. Nav
+// anchors it where the rover is when auton is turned on.
+LocalFrame::LocalFrame()
+{
+    Odometry origin;
+    origin.latitude_deg = 0;
+    origin.latitude_min = 0;
+    origin.longitude_deg = 0;
+    origin.longitude_min = 0;
+    anchor( origin );
+} // LocalFrame()
+
+// Moves the frame's origin to the given odometry. Points converted
+// before this are no longer in the frame.
+void LocalFrame::anchor( const Odometry& origin )
+{
+    mOriginLatitudeMin = totalMinutes( origin.latitude_deg, origin.latitude_min );
+    mOriginLongitudeMin = totalMinutes( origin.longitude_deg, origin.longitude_min );
+    mMetersPerLatitudeMin = EARTH_RADIUS * degreeToRadian( 0, 1 );
+    mMetersPerLongitudeMin = mMetersPerLatitudeMin *
+                             cos( degreeToRadian( origin.latitude_deg, origin.latitude_min ) );
+} // anchor()
+
+// Converts gps coordinates to a point in the frame.
+LocalPoint LocalFrame::toLocal( const Odometry& odometry ) const
+{
+    LocalPoint point;
+    point.east = ( totalMinutes( odometry.longitude_deg, odometry.longitude_min ) - mOriginLongitudeMin ) *
+                 mMetersPerLongitudeMin;
+    point.north = ( totalMinutes( odometry.latitude_deg, odometry.latitude_min ) - mOriginLatitudeMin ) *
+                  mMetersPerLatitudeMin;
+    return point;
+} // toLocal()
+
+// Converts a point in the frame to gps coordinates. The bearing and
+// speed are zero.
+Odometry LocalFrame::toOdometry( const LocalPoint& point ) const
+{
+    Odometry odometry;
+    splitMinutes( mOriginLatitudeMin + point.north / mMetersPerLatitudeMin,
+                  odometry.latitude_deg, odometry.latitude_min );
+    splitMinutes( mOriginLongitudeMin + point.east / mMetersPerLongitudeMin,
+                  odometry.longitude_deg, odometry.longitude_min );
+    odometry.bearing_deg = 0;
+    odometry.speed = 0;
+    return odometry;
+} // toOdometry()
@@ -0,0 +1,66 @@
+#ifndef LOCAL_FRAME_HPP
+#define LOCAL_FRAME_HPP
+
+#include "rover_msgs/Odometry.hpp"
+#include "rover_msgs/Waypoint.hpp"
+
+using namespace rover_msgs;
+
+// A position in the mission's local frame, in meters east and north of
+// where the rover was when auton was turned on.
+struct LocalPoint
+{
+    double east;
+    double north;
+};
+
+// A course waypoint along with its position in the local frame, so the
+// waypoint's odometry only has to be converted once.
+struct LocalWaypoint : public Waypoint
+{
+    LocalWaypoint();
+
+    LocalWaypoint( const Waypoint& waypoint, const LocalPoint& positionIn );
+
+    LocalPoint position;
+};
+
+// A local east-north frame around an origin. Nav does all of its
+// geometry in this frame, where distances and bearings are plain planar
+// math, and only converts gps coordinates at the edge, when odometry and
+// courses come in. The conversion is an equirectangular approximation on
+// the same spherical earth as the rest of nav: minutes of latitude and
+// longitude are scaled to meters by constants taken at the origin's
+// latitude. The longitude scale is really cos( latitude ) of each point,
+// so a point north meters north and east meters east of the origin is
+// off east by about east * north * tan( latitude ) / EARTH_RADIUS. That
+// is 10 to 15 cm 1 km out at mid latitudes and grows with the square of
+// the distance, so it is about a centimeter across a few hundred meter
+// course.
+class LocalFrame
+{
+public:
+    LocalFrame();
+
+    void anchor( const Odometry& origin );
+
+    LocalPoint toLocal( const Odometry& odometry ) const;
+
+    Odometry toOdometry( const LocalPoint& point ) const;
+
+private:
+    /*************************************************************************/
+    /* Private Member Variables */
+    /*************************************************************************/
+
+    // The origin's latitude and longitude in minutes.
+    double mOriginLatitudeMin;
+    double mOriginLongitudeMin;
+
+    // The length of a minute of latitude and of longitude at the
+    // origin, in meters.
+    double mMetersPerLatitudeMin;
+    double mMetersPerLongitudeMin;
+};
+
+#endif // LOCAL_FRAME_HPP
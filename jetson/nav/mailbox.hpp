@@ -0,0 +1,79 @@
+#ifndef MAILBOX_HPP
+#define MAILBOX_HPP
+
+#include <atomic>
+
+// Holds the latest value of a message passed from one writer thread to
+// one reader thread without either of them ever blocking. It is a
+// triple buffer: the writer fills one slot, the reader reads another,
+// and the third holds the newest complete value. Posting and fetching
+// are a single atomic exchange of that third slot with the writer's or
+// reader's own, so the reader always sees a whole message and the
+// writer can post any number of times between fetches, only the last
+// one being kept.
+template<typename T>
+class Mailbox
+{
+public:
+    Mailbox()
+        : mBack( 0 )
+        , mMiddle( 1 )
+        , mFront( 2 )
+    {}
+
+    Mailbox( const Mailbox& ) = delete;
+
+    Mailbox& operator=( const Mailbox& ) = delete;
+
+    // Writer only. The slot to fill before calling post().
+    T& back()
+    {
+        return mSlots[ mBack ];
+    } // back()
+
+    // Writer only. Makes the filled back slot the newest value.
+    void post()
+    {
+        mBack = mMiddle.exchange( mBack | NewBit, std::memory_order_acq_rel ) & IndexMask;
+    } // post()
+
+    // Writer only. Copies value in and posts it.
+    void post( const T& value )
+    {
+        back() = value;
+        post();
+    } // post()
+
+    // Reader only. Returns the newest value if one was posted since the
+    // last fetch, nullptr otherwise. The value stays valid and unchanged
+    // until the next fetch.
+    const T* fetch()
+    {
+        if( !( mMiddle.load( std::memory_order_relaxed ) & NewBit ) )
+        {
+            return nullptr;
+        }
+        mFront = mMiddle.exchange( mFront, std::memory_order_acq_rel ) & IndexMask;
+        return &mSlots[ mFront ];
+    } // fetch()
+
+private:
+    // The middle index is tagged with NewBit when it holds a value the
+    // reader hasn't fetched.
+    static constexpr unsigned IndexMask = 3;
+    static constexpr unsigned NewBit = 4;
+
+    T mSlots[ 3 ];
+
+    // The writer's slot. Kept apart from the reader's so the two
+    // threads don't share a cache line.
+    alignas( 64 ) unsigned mBack;
+
+    // The newest complete value's slot.
+    alignas( 64 ) std::atomic<unsigned> mMiddle;
+
+    // The reader's slot.
+    alignas( 64 ) unsigned mFront;
+}; // Mailbox
+
+#endif // MAILBOX_HPP
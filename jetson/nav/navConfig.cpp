@@ -0,0 +1,248 @@
+#include "navConfig.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+
+namespace
+{
+    // Reads typed values out of a parsed document, remembering the first
+    // key that was missing or had the wrong type.
+    class ConfigReader
+    {
+    public:
+        ConfigReader( const rapidjson::Value& root, string& error )
+            : mRoot( root )
+            , mError( error )
+        {}
+
+        bool ok() const
+        {
+            return mError.empty();
+        }
+
+        void read( const char* section, const char* key, double& out )
+        {
+            const rapidjson::Value* value = find( section, key );
+            if( !value )
+            {
+                return;
+            }
+            if( !value->IsNumber() )
+            {
+                fail( section, key, "a number" );
+                return;
+            }
+            out = value->GetDouble();
+        }
+
+        void read( const char* section, const char* key, int& out )
+        {
+            const rapidjson::Value* value = find( section, key );
+            if( !value )
+            {
+                return;
+            }
+            if( !value->IsInt() )
+            {
+                fail( section, key, "an integer" );
+                return;
+            }
+            out = value->GetInt();
+        }
+
+        void read( const char* section, const char* key, string& out )
+        {
+            const rapidjson::Value* value = find( section, key );
+            if( !value )
+            {
+                return;
+            }
+            if( !value->IsString() )
+            {
+                fail( section, key, "a string" );
+                return;
+            }
+            out = value->GetString();
+        }
+
+        void read( const char* section, const char* key, vector<int>& out )
+        {
+            const rapidjson::Value* value = find( section, key );
+            if( !value )
+            {
+                return;
+            }
+            if( !value->IsArray() || value->Empty() )
+            {
+                fail( section, key, "a non-empty array of integers" );
+                return;
+            }
+            out.clear();
+            for( const auto& element : value->GetArray() )
+            {
+                if( !element.IsInt() )
+                {
+                    fail( section, key, "a non-empty array of integers" );
+                    return;
+                }
+                out.push_back( element.GetInt() );
+            }
+        }
+
+        void read( const char* section, PidGains& out )
+        {
+            read( section, "kP", out.kP );
+            read( section, "kI", out.kI );
+            read( section, "kD", out.kD );
+        }
+
+        // Records a check on the values that the types alone don't catch.
+        void require( bool condition, const string& message )
+        {
+            if( ok() && !condition )
+            {
+                mError = message;
+            }
+        }
+
+    private:
+        const rapidjson::Value* find( const char* section, const char* key )
+        {
+            if( !ok() )
+            {
+                return nullptr;
+            }
+            auto sectionIt = mRoot.FindMember( section );
+            if( sectionIt == mRoot.MemberEnd() || !sectionIt->value.IsObject() )
+            {
+                mError = string( "missing section " ) + section;
+                return nullptr;
+            }
+            auto keyIt = sectionIt->value.FindMember( key );
+            if( keyIt == sectionIt->value.MemberEnd() )
+            {
+                mError = string( "missing " ) + section + "/" + key;
+                return nullptr;
+            }
+            return &keyIt->value;
+        }
+
+        void fail( const char* section, const char* key, const char* expected )
+        {
+            mError = string( section ) + "/" + key + " must be " + expected;
+        }
+
+        const rapidjson::Value& mRoot;
+        string& mError;
+    };
+} // namespace
+
+bool parseNavConfig( const string& text, NavConfig& config, string& error )
+{
+    rapidjson::Document document;
+    document.Parse( text.c_str() );
+    if( document.HasParseError() )
+    {
+        error = string( "json error at offset " ) + to_string( document.GetErrorOffset() ) + ": " +
+                rapidjson::GetParseError_En( document.GetParseError() );
+        return false;
+    }
+    if( !document.IsObject() )
+    {
+        error = "config must be a json object";
+        return false;
+    }
+
+    // Fill a copy so a bad file never leaves config half updated.
+    NavConfig parsed;
+    error.clear();
+    ConfigReader reader( document, error );
+
+    reader.read( "bearingPid", parsed.bearingPid );
+    reader.read( "distancePid", parsed.distancePid );
+
+    reader.read( "joystick", "bearingPower", parsed.joystick.bearingPower );
+    reader.read( "joystick", "drivingPower", parsed.joystick.drivingPower );
+    reader.read( "joystick", "dampen", parsed.joystick.dampen );
+
+    reader.read( "navThresholds", "turningBearing", parsed.navThresholds.turningBearing );
+    reader.read( "navThresholds", "drivingBearing", parsed.navThresholds.drivingBearing );
+    reader.read( "navThresholds", "waypointDistance", parsed.navThresholds.waypointDistance );
+    reader.read( "navThresholds", "targetDistance", parsed.navThresholds.targetDistance );
+    reader.read( "navThresholds", "minTurningEffort", parsed.navThresholds.minTurningEffort );
+    reader.read( "navThresholds", "gateCenteredAngleDiff", parsed.navThresholds.gateCenteredAngleDiff );
+    reader.read( "navThresholds", "obstacleDistanceThreshold", parsed.navThresholds.obstacleDistanceThreshold );
+
+    reader.read( "roverMeasurements", "width", parsed.roverMeasurements.width );
+
+    reader.read( "computerVision", "visionDistance", parsed.computerVision.visionDistance );
+    reader.read( "computerVision", "fieldOfViewAngle", parsed.computerVision.fieldOfViewAngle );
+    reader.read( "computerVision", "fieldOfViewSafeAngle", parsed.computerVision.fieldOfViewSafeAngle );
+
+    reader.read( "lcmChannels", "navStatusChannel", parsed.lcmChannels.navStatusChannel );
+    reader.read( "lcmChannels", "repeaterDropInitChannel", parsed.lcmChannels.repeaterDropInitChannel );
+    reader.read( "lcmChannels", "repeaterDropCompleteChannel", parsed.lcmChannels.repeaterDropCompleteChannel );
+    reader.read( "lcmChannels", "joystickChannel", parsed.lcmChannels.joystickChannel );
+    reader.read( "lcmChannels", "zedGimbalCommand", parsed.lcmChannels.zedGimbalCommand );
+    reader.read( "lcmChannels", "zedGimbalPosition", parsed.lcmChannels.zedGimbalPosition );
+    reader.read( "lcmChannels", "configChannel", parsed.lcmChannels.configChannel );
+    reader.read( "lcmChannels", "tickStatsChannel", parsed.lcmChannels.tickStatsChannel );
+
+    reader.read( "controlLoop", "frequency", parsed.controlLoop.frequency );
+    reader.read( "controlLoop", "statsInterval", parsed.controlLoop.statsInterval );
+
+    reader.read( "radioRepeaterThresholds", "signalStrengthCutOff", parsed.radioRepeaterThresholds.signalStrengthCutOff );
+    reader.read( "radioRepeaterThresholds", "lowSignalWaitTime", parsed.radioRepeaterThresholds.lowSignalWaitTime );
+
+    reader.read( "search", "order", parsed.search.order );
+    reader.read( "search", "numSearches", parsed.search.numSearches );
+    reader.read( "search", "bailThresh", parsed.search.bailThresh );
+    reader.read( "search", "searchWaitStepSize", parsed.search.searchWaitStepSize );
+    reader.read( "search", "searchWaitTime", parsed.search.searchWaitTime );
+
+    // The state machine indexes search/order with numSearches.
+    reader.require( parsed.search.numSearches > 0 &&
+                    parsed.search.numSearches <= static_cast<int>( parsed.search.order.size() ),
+                    "search/numSearches must be between 1 and the length of search/order" );
+    reader.require( parsed.computerVision.visionDistance > 0,
+                    "computerVision/visionDistance must be positive" );
+    reader.require( parsed.controlLoop.frequency > 0,
+                    "controlLoop/frequency must be positive" );
+    reader.require( parsed.controlLoop.statsInterval > 0,
+                    "controlLoop/statsInterval must be positive" );
+
+    if( !reader.ok() )
+    {
+        return false;
+    }
+    config = parsed;
+    return true;
+} // parseNavConfig()
+
+bool loadNavConfig( const string& path, NavConfig& config, string& error )
+{
+    ifstream configFile( path );
+    if( !configFile )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    stringstream text;
+    text << configFile.rdbuf();
+    if( !parseNavConfig( text.str(), config, error ) )
+    {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+} // loadNavConfig()
+
+string navConfigPath()
+{
+    const char* configRoot = getenv( "MROVER_CONFIG" );
+    return string( configRoot ? configRoot : "" ) + "/config_nav/config.json";
+} // navConfigPath()
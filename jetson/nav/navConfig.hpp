@@ -0,0 +1,101 @@
+#ifndef NAV_CONFIG_HPP
+#define NAV_CONFIG_HPP
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Gains for one of the rover's pid loops.
+struct PidGains
+{
+    double kP;
+    double kI;
+    double kD;
+};
+
+// The contents of config_nav/config.json, checked and converted once
+// when it is loaded so reading a value is a plain member access.
+// Members mirror the sections and keys of the json file.
+struct NavConfig
+{
+    PidGains bearingPid;
+
+    PidGains distancePid;
+
+    struct
+    {
+        double bearingPower;
+        double drivingPower;
+        double dampen;
+    } joystick;
+
+    struct
+    {
+        double turningBearing;
+        double drivingBearing;
+        double waypointDistance;
+        double targetDistance;
+        double minTurningEffort;
+        double gateCenteredAngleDiff;
+        double obstacleDistanceThreshold;
+    } navThresholds;
+
+    struct
+    {
+        double width;
+    } roverMeasurements;
+
+    struct
+    {
+        double visionDistance;
+        double fieldOfViewAngle;
+        double fieldOfViewSafeAngle;
+    } computerVision;
+
+    struct
+    {
+        string navStatusChannel;
+        string repeaterDropInitChannel;
+        string repeaterDropCompleteChannel;
+        string joystickChannel;
+        string zedGimbalCommand;
+        string zedGimbalPosition;
+        string configChannel;
+        string tickStatsChannel;
+    } lcmChannels;
+
+    struct
+    {
+        double frequency;
+        double statsInterval;
+    } controlLoop;
+
+    struct
+    {
+        double signalStrengthCutOff;
+        double lowSignalWaitTime;
+    } radioRepeaterThresholds;
+
+    struct
+    {
+        vector<int> order;
+        int numSearches;
+        double bailThresh;
+        double searchWaitStepSize;
+        double searchWaitTime;
+    } search;
+};
+
+// Parses json text into config. Every key must be present with the
+// right type. On failure config is left untouched and error says what
+// was wrong.
+bool parseNavConfig( const string& text, NavConfig& config, string& error );
+
+// Reads and parses the file at path, see parseNavConfig.
+bool loadNavConfig( const string& path, NavConfig& config, string& error );
+
+// The path of config_nav/config.json under $MROVER_CONFIG.
+string navConfigPath();
+
+#endif // NAV_CONFIG_HPP
@@ -9,17 +9,17 @@
 class SimpleAvoidance : public ObstacleAvoidanceStateMachine
 {
 public:
-    SimpleAvoidance( StateMachine* roverStateMachine, Rover* rover, const rapidjson::Document& roverConfig );
+    SimpleAvoidance( StateMachine* roverStateMachine, Rover* rover, const NavConfig& roverConfig );
 
     ~SimpleAvoidance();
 
-    NavState executeTurnAroundObs( Rover* rover, const rapidjson::Document& roverConfig );
+    NavState executeTurnAroundObs( Rover* rover, const NavConfig& roverConfig );
 
 
-    NavState executeDriveAroundObs( Rover* rover, const rapidjson::Document& roverConfig );
+    NavState executeDriveAroundObs( Rover* rover, const NavConfig& roverConfig );
 
 
-    Odometry createAvoidancePoint( Rover* rover, const double distance );
+    LocalPoint createAvoidancePoint( Rover* rover, const double distance );
 };
 
 #endif //SIMPLE_AVOIDANCE_HPP
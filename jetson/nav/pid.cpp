@@ -26,6 +26,12 @@ double PidLoop::update(double current, double desired) {
     return effort;
 }
 
+void PidLoop::setGains(double Kp, double Ki, double Kd) {
+    Kp_ = Kp;
+    Ki_ = Ki;
+    Kd_ = Kd;
+}
+
 void PidLoop::reset() {
     first_ = true;
     accumulated_error_ = 0.0;
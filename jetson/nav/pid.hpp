@@ -7,6 +7,9 @@ class PidLoop {
         double update(double current, double desired);
         void reset();
 
+        //Changes the gains without resetting the loop
+        void setGains(double Kp, double Ki, double Kd);
+
     private:
         double error(double current, double desired);
 
@@ -9,6 +9,9 @@
 // state to off.
 Rover::RoverStatus::RoverStatus()
     : mCurrentState( NavState::Off )
+    , mPosition{ 0, 0 }
+    , mPathTargets( 0 )
+    , mChanged( 0 )
 {
     mAutonState.is_auton = false;
 } // RoverStatus()
@@ -32,7 +35,7 @@ Course& Rover::RoverStatus::course()
 } // course()
 
 // Gets a reference to the rover's path.
-deque<Waypoint>& Rover::RoverStatus::path()
+deque<LocalWaypoint>& Rover::RoverStatus::path()
 {
     return mPath;
 } // path()
@@ -49,6 +52,12 @@ Odometry& Rover::RoverStatus::odometry()
     return mOdometry;
 } // odometry()
 
+// Gets a reference to the rover's current position in the local frame.
+LocalPoint& Rover::RoverStatus::position()
+{
+    return mPosition;
+} // position()
+
 // Gets a reference to the rover's first target's current information.
 Target& Rover::RoverStatus::target()
 {
@@ -68,59 +77,98 @@ unsigned Rover::RoverStatus::getPathTargets()
   return mPathTargets;
 } // getPathTargets()
 
-// Assignment operator for the rover status object. Does a "deep" copy
-// where necessary.
-Rover::RoverStatus& Rover::RoverStatus::operator=( Rover::RoverStatus& newRoverStatus )
+// Marks the given fields as set since they were last taken.
+void Rover::RoverStatus::markChanged( unsigned fields )
 {
-    mAutonState = newRoverStatus.autonState();
-    mCourse = newRoverStatus.course();
-    mPathTargets = 0;
+    mChanged |= fields;
+} // markChanged()
 
-    while( !mPath.empty() )
+// Returns true if any of the given fields were set since they were
+// last taken.
+bool Rover::RoverStatus::isChanged( unsigned fields ) const
+{
+    return ( mChanged & fields ) != 0;
+} // isChanged()
+
+// Copies those of the given fields that have changed in newRoverStatus
+// and clears their marks there, so a field is only copied once per
+// update. The course is only marked when its hash changes, so the
+// waypoint list is copied once per course rather than on every update.
+void Rover::RoverStatus::take( RoverStatus& newRoverStatus, unsigned fields )
+{
+    fields &= newRoverStatus.mChanged;
+    if( fields & AutonStateField )
     {
-        mPath.pop_front();
+        mAutonState = newRoverStatus.mAutonState;
     }
-    for( int courseIndex = 0; courseIndex < mCourse.num_waypoints; ++courseIndex )
+    if( fields & CourseField )
     {
-        auto &wp = mCourse.waypoints[ courseIndex ];
-        mPath.push_back( wp );
-        if (wp.search) {
-            ++mPathTargets;
+        mCourse = newRoverStatus.mCourse;
+        mPathTargets = 0;
+        for( const Waypoint& waypoint : mCourse.waypoints )
+        {
+            if( waypoint.search )
+            {
+                ++mPathTargets;
+            }
         }
     }
-    mObstacle = newRoverStatus.obstacle();
-    mOdometry = newRoverStatus.odometry();
-    mTarget1 = newRoverStatus.target();
-    mTarget2 = newRoverStatus.target2();
-    mSignal = newRoverStatus.radio();
-    return *this;
-} // operator=
+    if( fields & ObstacleField )
+    {
+        mObstacle = newRoverStatus.mObstacle;
+    }
+    if( fields & OdometryField )
+    {
+        mOdometry = newRoverStatus.mOdometry;
+    }
+    if( fields & TargetsField )
+    {
+        mTarget1 = newRoverStatus.mTarget1;
+        mTarget2 = newRoverStatus.mTarget2;
+    }
+    if( fields & RadioField )
+    {
+        mSignal = newRoverStatus.mSignal;
+    }
+    newRoverStatus.mChanged &= ~fields;
+} // take()
+
+// Refills the path with every waypoint of the course, converted to the
+// given frame. The path is emptied when the rover turns off, so this is
+// done each time it turns on.
+void Rover::RoverStatus::resetPath( const LocalFrame& frame )
+{
+    mPath.clear();
+    for( const Waypoint& waypoint : mCourse.waypoints )
+    {
+        mPath.emplace_back( waypoint, frame.toLocal( waypoint.odom ) );
+    }
+} // resetPath()
 
 // Constructs a rover object with the given configuration file and lcm
 // object with which to use for communications.
-Rover::Rover( const rapidjson::Document& config, lcm::LCM& lcmObject )
+Rover::Rover( const NavConfig& config, lcm::LCM& lcmObject )
     : mRoverConfig( config )
     , mLcmObject( lcmObject )
-    , mDistancePid( config[ "distancePid" ][ "kP" ].GetDouble(),
-                    config[ "distancePid" ][ "kI" ].GetDouble(),
-                    config[ "distancePid" ][ "kD" ].GetDouble() )
-    , mBearingPid( config[ "bearingPid" ][ "kP" ].GetDouble(),
-                   config[ "bearingPid" ][ "kI" ].GetDouble(),
-                   config[ "bearingPid" ][ "kD" ].GetDouble() )
+    , mDistancePid( config.distancePid.kP,
+                    config.distancePid.kI,
+                    config.distancePid.kD )
+    , mBearingPid( config.bearingPid.kP,
+                   config.bearingPid.kI,
+                   config.bearingPid.kD )
     , mTimeToDropRepeater( false )
-    , mLongMeterInMinutes( -1 )
 {
 } // Rover()
 
-// Sends a joystick command to drive forward from the current odometry
-// to the destination odometry. This joystick command will also turn
+// Sends a joystick command to drive forward from the current position
+// to the destination point. This joystick command will also turn
 // the rover small amounts as "course corrections".
 // The return value indicates if the rover has arrived or if it is
 // on-course or off-course.
-DriveStatus Rover::drive( const Odometry& destination )
+DriveStatus Rover::drive( const LocalPoint& destination )
 {
-    double distance = estimateNoneuclid( mRoverStatus.odometry(), destination );
-    double bearing = calcBearing( mRoverStatus.odometry(), destination );
+    double distance = calcDistance( mRoverStatus.position(), destination );
+    double bearing = calcBearing( mRoverStatus.position(), destination );
     return drive( distance, bearing, false );
 } // drive()
 
@@ -134,8 +182,8 @@ DriveStatus Rover::drive( const Odometry& destination )
 // on-course or off-course.
 DriveStatus Rover::drive( const double distance, const double bearing, const bool target )
 {
-    if( (!target && distance < mRoverConfig[ "navThresholds" ][ "waypointDistance" ].GetDouble()) ||
-        (target && distance < mRoverConfig[ "navThresholds" ][ "targetDistance" ].GetDouble()) )
+    if( (!target && distance < mRoverConfig.navThresholds.waypointDistance) ||
+        (target && distance < mRoverConfig.navThresholds.targetDistance) )
     {
         return DriveStatus::Arrived;
     }
@@ -143,7 +191,7 @@ DriveStatus Rover::drive( const double distance, const double bearing, const boo
     double destinationBearing = mod( bearing, 360 );
     throughZero( destinationBearing, mRoverStatus.odometry().bearing_deg ); // will go off course if inside if because through zero not calculated
 
-    if( fabs( destinationBearing - mRoverStatus.odometry().bearing_deg ) < mRoverConfig[ "navThresholds" ][ "drivingBearing" ].GetDouble() )
+    if( fabs( destinationBearing - mRoverStatus.odometry().bearing_deg ) < mRoverConfig.navThresholds.drivingBearing )
     {
         double distanceEffort = mDistancePid.update( -1 * distance, 0 );
         double turningEffort = mBearingPid.update( mRoverStatus.odometry().bearing_deg, destinationBearing );
@@ -169,11 +217,11 @@ void Rover::drive(const int direction, const double bearing)
 } // drive()
 
 // Sends a joystick command to turn the rover toward the destination
-// odometry. Returns true if the rover has finished turning, false
+// point. Returns true if the rover has finished turning, false
 // otherwise.
-bool Rover::turn( Odometry& destination )
+bool Rover::turn( const LocalPoint& destination )
 {
-    double bearing = calcBearing( mRoverStatus.odometry(), destination );
+    double bearing = calcBearing( mRoverStatus.position(), destination );
     return turn( bearing );
 } // turn()
 
@@ -191,14 +239,14 @@ bool Rover::turn( double bearing )
     }
     else
     {
-        turningBearingThreshold = mRoverConfig[ "navThresholds" ][ "turningBearing" ].GetDouble();
+        turningBearingThreshold = mRoverConfig.navThresholds.turningBearing;
     }
     if( fabs( bearing - mRoverStatus.odometry().bearing_deg ) <= turningBearingThreshold )
     {
         return true;
     }
     double turningEffort = mBearingPid.update( mRoverStatus.odometry().bearing_deg, bearing );
-    double minTurningEffort = mRoverConfig[ "navThresholds" ][ "minTurningEffort" ].GetDouble() * (turningEffort < 0 ? -1 : 1);
+    double minTurningEffort = mRoverConfig.navThresholds.minTurningEffort * (turningEffort < 0 ? -1 : 1);
     if( isTurningAroundObstacle( mRoverStatus.currentState() ) && fabs(turningEffort) < minTurningEffort )
     {
         turningEffort = minTurningEffort;
@@ -214,37 +262,45 @@ void Rover::stop()
 } // stop()
 
 // Checks if the rover should be updated based on what information in
-// the rover's status has changed. Returns true if the rover was
-// updated, false otherwise.
+// the rover's status has changed. Only the fields marked as changed in
+// newRoverStatus are compared and copied, and their marks are cleared.
+// Returns true if the rover was updated, false otherwise.
 // TODO: unconditionally update everygthing. When abstracting search class
 // we got rid of NavStates TurnToTarget and DriveToTarget (oops) fix this soon :P
-bool Rover::updateRover( RoverStatus newRoverStatus )
+bool Rover::updateRover( RoverStatus& newRoverStatus )
 {
+    const unsigned sensorFields = RoverStatus::ObstacleField |
+                                  RoverStatus::OdometryField |
+                                  RoverStatus::TargetsField;
+
     // Rover currently on.
     if( mRoverStatus.autonState().is_auton )
     {
         // Rover turned off
         if( !newRoverStatus.autonState().is_auton )
         {
-            mRoverStatus.autonState() = newRoverStatus.autonState();
+            mRoverStatus.take( newRoverStatus, RoverStatus::AutonStateField );
             return true;
         }
+        mRoverStatus.take( newRoverStatus, RoverStatus::AutonStateField );
 
-        // If any data has changed, update all data
-        if( !isEqual( mRoverStatus.obstacle(), newRoverStatus.obstacle() ) ||
-            !isEqual( mRoverStatus.odometry(), newRoverStatus.odometry() ) ||
-            !isEqual( mRoverStatus.target(), newRoverStatus.target()) ||
-            !isEqual( mRoverStatus.target2(), newRoverStatus.target2()) )
+        if( !newRoverStatus.isChanged( sensorFields ) )
         {
-            mRoverStatus.obstacle() = newRoverStatus.obstacle();
-            mRoverStatus.odometry() = newRoverStatus.odometry();
-            mRoverStatus.target() = newRoverStatus.target();
-            mRoverStatus.radio() = newRoverStatus.radio();
-            updateRepeater(mRoverStatus.radio());
-            return true;
+            return false;
         }
 
-        return false;
+        // If any data has changed, update all data
+        bool changed = !isEqual( mRoverStatus.obstacle(), newRoverStatus.obstacle() ) ||
+                       !isEqual( mRoverStatus.odometry(), newRoverStatus.odometry() ) ||
+                       !isEqual( mRoverStatus.target(), newRoverStatus.target() ) ||
+                       !isEqual( mRoverStatus.target2(), newRoverStatus.target2() );
+        mRoverStatus.take( newRoverStatus, sensorFields | RoverStatus::RadioField );
+        mRoverStatus.position() = mFrame.toLocal( mRoverStatus.odometry() );
+        if( changed )
+        {
+            updateRepeater( mRoverStatus.radio() );
+        }
+        return changed;
     }
 
     // Rover currently off.
@@ -253,22 +309,34 @@ bool Rover::updateRover( RoverStatus newRoverStatus )
         // Rover turned on.
         if( newRoverStatus.autonState().is_auton )
         {
-            mRoverStatus = newRoverStatus;
-            // Calculate longitude minutes/meter conversion.
-            mLongMeterInMinutes = 60 / ( EARTH_CIRCUM * cos( degreeToRadian(
-                mRoverStatus.odometry().latitude_deg, mRoverStatus.odometry().latitude_min ) ) / 360 );
+            mRoverStatus.take( newRoverStatus, ~0u );
+            // Anchor the local frame here and convert the course into it.
+            mFrame.anchor( mRoverStatus.odometry() );
+            mRoverStatus.position() = mFrame.toLocal( mRoverStatus.odometry() );
+            mRoverStatus.resetPath( mFrame );
             return true;
         }
         return false;
     }
 } // updateRover()
 
-// Calculates the conversion from minutes to meters based on the
-// rover's current latitude.
-const double Rover::longMeterInMinutes() const
+// Gets the frame the rover's position and path are in.
+const LocalFrame& Rover::frame() const
 {
-    return mLongMeterInMinutes;
-}
+    return mFrame;
+} // frame()
+
+// Picks up values from a reloaded configuration that were copied out
+// of it. Everything else is read through mRoverConfig directly.
+void Rover::updateConfig()
+{
+    mDistancePid.setGains( mRoverConfig.distancePid.kP,
+                           mRoverConfig.distancePid.kI,
+                           mRoverConfig.distancePid.kD );
+    mBearingPid.setGains( mRoverConfig.bearingPid.kP,
+                          mRoverConfig.bearingPid.kI,
+                          mRoverConfig.bearingPid.kD );
+} // updateConfig()
 
 // Executes the logic starting the clock to time how long it's been
 // since the rover has gotten a strong radio signal. If the signal drops
@@ -277,21 +345,21 @@ const double Rover::longMeterInMinutes() const
 void Rover::updateRepeater(RadioSignalStrength& radioSignal)
 {
     static bool started = false;
-    static time_t startTime;
+    static double startTime;
 
     // If we haven't already dropped a repeater, the time hasn't already started
     // and our signal is below the threshold, start the timer
     if( !mTimeToDropRepeater &&
         !started &&
         radioSignal.signal_strength <=
-        mRoverConfig[ "radioRepeaterThresholds" ][ "signalStrengthCutOff" ].GetDouble())
+        mRoverConfig.radioRepeaterThresholds.signalStrengthCutOff)
     {
-        startTime = time( nullptr );
+        startTime = navTime();
         started = true;
     }
 
-    double waitTime = mRoverConfig[ "radioRepeaterThresholds" ][ "lowSignalWaitTime" ].GetDouble();
-    if( started && difftime( time( nullptr ), startTime ) > waitTime )
+    double waitTime = mRoverConfig.radioRepeaterThresholds.lowSignalWaitTime;
+    if( started && navTime() - startTime > waitTime )
     {
         started = false;
         mTimeToDropRepeater = true;
@@ -328,13 +396,13 @@ void Rover::publishJoystick( const double forwardBack, const double leftRight, c
 {
     Joystick joystick;
     // power limit (0 = 50%, 1 = 0%, -1 = 100% power)
-    joystick.dampen = mRoverConfig[ "joystick" ][ "dampen" ].GetDouble();
-    double drivingPower = mRoverConfig[ "joystick" ][ "drivingPower" ].GetDouble();
+    joystick.dampen = mRoverConfig.joystick.dampen;
+    double drivingPower = mRoverConfig.joystick.drivingPower;
     joystick.forward_back = drivingPower * forwardBack;
-    double bearingPower = mRoverConfig[ "joystick" ][ "bearingPower" ].GetDouble();
+    double bearingPower = mRoverConfig.joystick.bearingPower;
     joystick.left_right = bearingPower * leftRight;
     joystick.kill = kill;
-    string joystickChannel = mRoverConfig[ "lcmChannels" ][ "joystickChannel" ].GetString();
+    const string& joystickChannel = mRoverConfig.lcmChannels.joystickChannel;
     mLcmObject.publish( joystickChannel, &joystick );
 } // publishJoystick()
 
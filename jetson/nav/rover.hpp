@@ -13,7 +13,8 @@
 #include "rover_msgs/RadioSignalStrength.hpp"
 #include "rover_msgs/TargetList.hpp"
 #include "rover_msgs/Waypoint.hpp"
-#include "rapidjson/document.h"
+#include "localFrame.hpp"
+#include "navConfig.hpp"
 #include "pid.hpp"
 
 using namespace rover_msgs;
@@ -87,6 +88,19 @@ public:
     class RoverStatus
     {
     public:
+        // The parts of the status that are tracked for changes. A
+        // status that collects incoming messages marks the parts each
+        // message sets, and the rover only copies the marked ones.
+        enum Field
+        {
+            AutonStateField = 1 << 0,
+            CourseField = 1 << 1,
+            ObstacleField = 1 << 2,
+            OdometryField = 1 << 3,
+            TargetsField = 1 << 4,
+            RadioField = 1 << 5
+        };
+
         RoverStatus();
 
         RoverStatus(
@@ -107,12 +121,14 @@ public:
 
         Course& course();
 
-        deque<Waypoint>& path();
+        deque<LocalWaypoint>& path();
 
         Obstacle& obstacle();
 
         Odometry& odometry();
 
+        LocalPoint& position();
+
         Target& target();
 
         Target& target2();
@@ -121,7 +137,13 @@ public:
 
         unsigned getPathTargets();
 
-        RoverStatus& operator=( RoverStatus& newRoverStatus );
+        void markChanged( unsigned fields );
+
+        bool isChanged( unsigned fields ) const;
+
+        void take( RoverStatus& newRoverStatus, unsigned fields );
+
+        void resetPath( const LocalFrame& frame );
 
     private:
         // The rover's current navigation state.
@@ -136,7 +158,7 @@ public:
         // The rover's current path. The path is initially the same as
         // the rover's course, however, as waypoints are visited, the
         // are removed from the path but not the course.
-        deque<Waypoint> mPath;
+        deque<LocalWaypoint> mPath;
 
         // The rover's current obstacle information from computer
         // vision.
@@ -145,6 +167,9 @@ public:
         // The rover's current odometry information.
         Odometry mOdometry;
 
+        // The rover's current position in the local frame.
+        LocalPoint mPosition;
+
         // The rover's current target information from computer
         // vision.
         Target mTarget1;
@@ -156,23 +181,26 @@ public:
 
         // Total targets to seach for in the course
         unsigned mPathTargets;
+
+        // The fields set since they were last taken, see Field.
+        unsigned mChanged;
     };
 
-    Rover( const rapidjson::Document& config, lcm::LCM& lcm_in );
+    Rover( const NavConfig& config, lcm::LCM& lcm_in );
 
-    DriveStatus drive( const Odometry& destination );
+    DriveStatus drive( const LocalPoint& destination );
 
     DriveStatus drive( const double distance, const double bearing, const bool target = false );
 
     void drive(const int direction, const double bearing);
 
-    bool turn( Odometry& destination );
+    bool turn( const LocalPoint& destination );
 
     bool turn( double bearing );
 
     void stop();
 
-    bool updateRover( RoverStatus newRoverStatus );
+    bool updateRover( RoverStatus& newRoverStatus );
 
     RoverStatus& roverStatus();
 
@@ -180,10 +208,12 @@ public:
 
     PidLoop& bearingPid();
 
-    const double longMeterInMinutes() const;
+    const LocalFrame& frame() const;
 
     void updateRepeater( RadioSignalStrength& signal);
 
+    void updateConfig();
+
     bool isTimeToDropRepeater();
 
 private:
@@ -208,7 +238,7 @@ private:
     RoverStatus mRoverStatus;
 
     // A reference to the configuration file.
-    const rapidjson::Document& mRoverConfig;
+    const NavConfig& mRoverConfig;
 
     // A reference to the lcm object that will be used for
     // communicating with the actual rover and the base station.
@@ -223,9 +253,9 @@ private:
     // If it is time to drop a radio repeater
     bool mTimeToDropRepeater;
 
-    // The conversion factor from arcminutes to meters. This is based
-    // on the rover's current latitude.
-    double mLongMeterInMinutes;
+    // The frame nav's geometry is done in, anchored where the rover
+    // was when auton was last turned on.
+    LocalFrame mFrame;
 };
 
 #endif // ROVER_HPP
@@ -9,14 +9,14 @@
 class LawnMower : public SearchStateMachine
 {
 public:
-    LawnMower( StateMachine* stateMachine_, Rover* rover, const rapidjson::Document& roverConfig )
+    LawnMower( StateMachine* stateMachine_, Rover* rover, const NavConfig& roverConfig )
     : SearchStateMachine( stateMachine_, rover, roverConfig ) {}
 
     ~LawnMower();
 
     // Initializes the search point multipliers to be the intermost loop
     // of the search.
-    void initializeSearch( Rover* rover, const rapidjson::Document& roverConfig, const double pathWidth );
+    void initializeSearch( Rover* rover, const NavConfig& roverConfig, const double pathWidth );
 };
 
 #endif //LAWN_MOWER_SEARCH_HPP
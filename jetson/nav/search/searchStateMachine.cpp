@@ -11,7 +11,7 @@
 #include <cmath>
 
 // Constructs an SearchStateMachine object with roverStateMachine, mRoverConfig, and mRover
-SearchStateMachine::SearchStateMachine(StateMachine* roverStateMachine, Rover* rover, const rapidjson::Document& roverConfig)
+SearchStateMachine::SearchStateMachine(StateMachine* roverStateMachine, Rover* rover, const NavConfig& roverConfig)
     : roverStateMachine( roverStateMachine ) 
     , mRover( rover ) 
     , mRoverConfig( roverConfig ) {}
@@ -71,7 +71,7 @@ NavState SearchStateMachine::run()
 NavState SearchStateMachine::executeSearchSpin()
 {
     // degrees to turn to before performing a search wait.
-    double waitStepSize = mRoverConfig[ "search" ][ "searchWaitStepSize" ].GetDouble();
+    double waitStepSize = mRoverConfig.search.searchWaitStepSize;
     static double nextStop = 0; // to force the rover to wait initially
     static double mOriginalSpinAngle = 0; //initialize, is corrected on first call
 
@@ -108,7 +108,7 @@ NavState SearchStateMachine::executeSearchSpin()
 NavState SearchStateMachine::executeRoverWait()
 {
     static bool started = false;
-    static time_t startTime;
+    static double startTime;
 
     if( mRover->roverStatus().target().distance >= 0 )
     {
@@ -119,11 +119,11 @@ NavState SearchStateMachine::executeRoverWait()
     if( !started )
     {
         mRover->stop();
-        startTime = time( nullptr );
+        startTime = navTime();
         started = true;
     }
-    double waitTime = mRoverConfig[ "search" ][ "searchWaitTime" ].GetDouble();
-    if( difftime( time( nullptr ), startTime ) > waitTime )
+    double waitTime = mRoverConfig.search.searchWaitTime;
+    if( navTime() - startTime > waitTime )
     {
         started = false;
         if ( mRover->roverStatus().currentState() == NavState::SearchSpinWait )
@@ -159,7 +159,7 @@ NavState SearchStateMachine::executeSearchTurn()
                                        mRover->roverStatus().odometry().bearing_deg );
         return NavState::TurnToTarget;
     }
-    Odometry& nextSearchPoint = mSearchPoints.front();
+    const LocalPoint& nextSearchPoint = mSearchPoints.front();
     if( mRover->turn( nextSearchPoint ) )
     {
         return NavState::SearchDrive;
@@ -189,7 +189,7 @@ NavState SearchStateMachine::executeSearchDrive()
         roverStateMachine->updateObstacleDistance( mRover->roverStatus().obstacle().distance );
         return NavState::SearchTurnAroundObs;
     }
-    const Odometry& nextSearchPoint = mSearchPoints.front();
+    const LocalPoint& nextSearchPoint = mSearchPoints.front();
     DriveStatus driveStatus = mRover->drive( nextSearchPoint );
 
     if( driveStatus == DriveStatus::Arrived )
@@ -267,10 +267,9 @@ NavState SearchStateMachine::executeDriveToTarget()
             const double absAngle = mod(mRover->roverStatus().odometry().bearing_deg +
                                         mRover->roverStatus().target().bearing,
                                         360);
-            roverStateMachine->mGateStateMachine->lastKnownPost1.odom = createOdom( mRover->roverStatus().odometry(),
-                                                                                    absAngle,
-                                                                                    mRover->roverStatus().target().distance,
-                                                                                    mRover );
+            roverStateMachine->mGateStateMachine->lastKnownPost1.position = createPoint( mRover->roverStatus().position(),
+                                                                                         absAngle,
+                                                                                         mRover->roverStatus().target().distance );
             roverStateMachine->mGateStateMachine->lastKnownPost1.id = mRover->roverStatus().target().id;
             return NavState::GateSpin;
         }
@@ -312,14 +311,14 @@ void SearchStateMachine::updateTargetDetectionElements( double target_bearing, d
 // The maximum separation between any points in the search point list is determined by the rover's sight distance.
 void SearchStateMachine::insertIntermediatePoints()
 {
-    double visionDistance = mRoverConfig[ "computerVision" ][ "visionDistance" ].GetDouble();
+    double visionDistance = mRoverConfig.computerVision.visionDistance;
     const double maxDifference = 2 * visionDistance;
 
     for( int i = 0; i < int( mSearchPoints.size() ) - 1; ++i )
     {
-        Odometry point1 = mSearchPoints.at( i );
-        Odometry point2 = mSearchPoints.at( i + 1 );
-        double distance = estimateNoneuclid( point1, point2 );
+        LocalPoint point1 = mSearchPoints.at( i );
+        LocalPoint point2 = mSearchPoints.at( i + 1 );
+        double distance = calcDistance( point1, point2 );
         if ( distance > maxDifference )
         {
             int numPoints = int( ceil( distance / maxDifference ) - 1 );
@@ -327,10 +326,10 @@ void SearchStateMachine::insertIntermediatePoints()
             double bearing = calcBearing( point1, point2 );
             for ( int j = 0; j < numPoints; ++j )
             {
-                Odometry startPoint = mSearchPoints.at( i );
-                Odometry newOdom = createOdom( startPoint, bearing, newDifference, mRover );
+                LocalPoint startPoint = mSearchPoints.at( i );
+                LocalPoint newPoint = createPoint( startPoint, bearing, newDifference );
                 auto insertPosition = mSearchPoints.begin() + i + 1;
-                mSearchPoints.insert( insertPosition, newOdom );
+                mSearchPoints.insert( insertPosition, newPoint );
                 ++i;
             }
         }
@@ -339,7 +338,7 @@ void SearchStateMachine::insertIntermediatePoints()
 
 // The search factory allows for the creation of search objects and
 // an ease of transition between search algorithms
-SearchStateMachine* SearchFactory( StateMachine* stateMachine, SearchType type, Rover* rover, const rapidjson::Document& roverConfig )  //TODO
+SearchStateMachine* SearchFactory( StateMachine* stateMachine, SearchType type, Rover* rover, const NavConfig& roverConfig )  //TODO
 {
     SearchStateMachine* search = nullptr;
     switch (type)
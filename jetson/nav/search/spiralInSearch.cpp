@@ -9,7 +9,7 @@ SpiralIn::~SpiralIn() {}
 
 // Initializes the search ponit multipliers to be the intermost loop
 // of the search.
-void SpiralIn::initializeSearch( Rover* rover, const rapidjson::Document& roverConfig, const double visionDistance )
+void SpiralIn::initializeSearch( Rover* rover, const NavConfig& roverConfig, const double visionDistance )
 {
     mSearchPoints.clear();
 
@@ -19,18 +19,12 @@ void SpiralIn::initializeSearch( Rover* rover, const rapidjson::Document& roverC
     mSearchPointMultipliers.push_back( pair<short, short> (  1,  1 ) );
     mSearchPointMultipliers.push_back( pair<short, short> (  1, -1 ) );
 
-    while( mSearchPointMultipliers[ 0 ].second * visionDistance < roverConfig[ "search" ][ "bailThresh" ].GetDouble() ) {
+    while( mSearchPointMultipliers[ 0 ].second * visionDistance < roverConfig.search.bailThresh ) {
         for( auto& mSearchPointMultiplier : mSearchPointMultipliers )
         {
-            Odometry nextSearchPoint = rover->roverStatus().path().front().odom;
-            double totalLatitudeMinutes = nextSearchPoint.latitude_min +
-                ( mSearchPointMultiplier.first * visionDistance  * LAT_METER_IN_MINUTES );
-            double totalLongitudeMinutes = nextSearchPoint.longitude_min +
-                ( mSearchPointMultiplier.second * visionDistance * rover->longMeterInMinutes() );
-            nextSearchPoint.latitude_deg += totalLatitudeMinutes / 60;
-            nextSearchPoint.latitude_min = ( totalLatitudeMinutes - ( ( (int) totalLatitudeMinutes ) / 60 ) * 60 );
-            nextSearchPoint.longitude_deg += totalLongitudeMinutes / 60;
-            nextSearchPoint.longitude_min = ( totalLongitudeMinutes - ( ( (int) totalLongitudeMinutes) / 60 ) * 60 );
+            LocalPoint nextSearchPoint = rover->roverStatus().path().front().position;
+            nextSearchPoint.north += mSearchPointMultiplier.first * visionDistance;
+            nextSearchPoint.east += mSearchPointMultiplier.second * visionDistance;
 
             mSearchPoints.push_back( nextSearchPoint );
 
@@ -9,14 +9,14 @@
 class SpiralIn : public SearchStateMachine
 {
 public:
-    SpiralIn( StateMachine* stateMachine_, Rover* rover, const rapidjson::Document& roverConfig )
+    SpiralIn( StateMachine* stateMachine_, Rover* rover, const NavConfig& roverConfig )
     : SearchStateMachine( stateMachine_, rover, roverConfig ) {} 
 
     ~SpiralIn();
 
     // Initializes the search ponit multipliers to be the intermost loop
     // of the search.
-    void initializeSearch( Rover* rover, const rapidjson::Document& roverConfig, const double pathWidth );
+    void initializeSearch( Rover* rover, const NavConfig& roverConfig, const double pathWidth );
 };
 
 #endif //SPIRAL_IN_SEARCH_HPP
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "navSimulator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "utilities.hpp"
+#include "rover_msgs/AutonState.hpp"
+#include "rover_msgs/Course.hpp"
+#include "rover_msgs/RadioSignalStrength.hpp"
+
+namespace
+{
+    // Simulated seconds since the mission started. Nav reads it
+    // through setNavClock while a simulator exists.
+    double simTime = 0;
+
+    double simClock()
+    {
+        return simTime;
+    } // simClock()
+
+    double clamp( const double value, const double low, const double high )
+    {
+        return max( low, min( high, value ) );
+    } // clamp()
+
+    // Where a spot on the field is as seen from the rover: meters ahead,
+    // meters to the right, its distance and its bearing in degrees from
+    // straight ahead, positive to the right.
+    struct Relative
+    {
+        double ahead;
+        double right;
+        double distance;
+        double bearing;
+    };
+
+    Relative relativeTo( const SimPoint& position, const double bearing, const SimPoint& point )
+    {
+        double dx = point.x - position.x;
+        double dy = point.y - position.y;
+        double heading = degreeToRadian( bearing );
+        Relative relative;
+        relative.ahead = dx * sin( heading ) + dy * cos( heading );
+        relative.right = dx * cos( heading ) - dy * sin( heading );
+        relative.distance = hypot( dx, dy );
+        relative.bearing = radianToDegree( atan2( relative.right, relative.ahead ) );
+        return relative;
+    } // relativeTo()
+} // namespace
+
+// Constructs a simulator for one mission on field. Nav's config is read
+// from $MROVER_CONFIG as it is on the rover.
+NavSimulator::NavSimulator( const SimField& field, const SimOptions& options )
+    : mField( field )
+    , mOptions( options )
+    , mLcmObject( "memq://" )
+    , mStateMachine( mLcmObject )
+    , mReceiver( mLcmObject, mStateMachine.configChannel() )
+    , mPosition( field.start )
+    , mBearing( field.startBearing )
+    , mSpeed( 0 )
+    , mColliding( false )
+    , mResult()
+{
+    mJoystick.forward_back = 0;
+    mJoystick.left_right = 0;
+    mJoystick.dampen = -1;
+    mJoystick.kill = false;
+    mJoystick.restart = false;
+    mNavStatus.completed_wps = 0;
+    mNavStatus.total_wps = 0;
+
+    const NavConfig& config = mStateMachine.config();
+    mLcmObject.subscribe( config.lcmChannels.joystickChannel, &NavSimulator::joystick, this );
+    mLcmObject.subscribe( config.lcmChannels.navStatusChannel, &NavSimulator::navStatus, this );
+
+    simTime = 0;
+    setNavClock( &simClock );
+} // NavSimulator()
+
+NavSimulator::~NavSimulator()
+{
+    setNavClock( nullptr );
+} // ~NavSimulator()
+
+// Runs the mission until nav is done or the time limit passes. Each
+// iteration is one control tick at nav's configured rate: publish what
+// the rover senses, let nav handle it and run, then move the rover by
+// the command nav sent for one tick.
+SimResult NavSimulator::run()
+{
+    auto wallStart = chrono::steady_clock::now();
+    double dt = 1 / mStateMachine.config().controlLoop.frequency;
+
+    publishCourse();
+    AutonState autonState;
+    autonState.is_auton = true;
+    mLcmObject.publish( "/auton", &autonState );
+
+    while( true )
+    {
+        publishSensors();
+        pumpLcm();
+        mReceiver.deliver( mStateMachine );
+        mStateMachine.run();
+        ++mResult.ticks;
+        pumpLcm();
+
+        if( mNavStatus.nav_state_name == "Done" )
+        {
+            mResult.completed = true;
+            break;
+        }
+        if( simTime >= mOptions.timeLimit )
+        {
+            break;
+        }
+
+        step( dt );
+        simTime += dt;
+
+        bool colliding = isColliding();
+        if( colliding && !mColliding )
+        {
+            ++mResult.collisions;
+        }
+        mColliding = colliding;
+    }
+
+    mResult.missionTime = simTime;
+    mResult.completedWaypoints = mNavStatus.completed_wps;
+    mResult.totalWaypoints = static_cast<int>( mField.waypoints.size() );
+    mResult.wallTime = chrono::duration<double>( chrono::steady_clock::now() - wallStart ).count();
+    return mResult;
+} // run()
+
+// Publishes the field's waypoints as the course.
+void NavSimulator::publishCourse()
+{
+    Course course;
+    course.num_waypoints = static_cast<int32_t>( mField.waypoints.size() );
+    course.hash = 1;
+    for( const SimWaypoint& simWaypoint : mField.waypoints )
+    {
+        Waypoint waypoint;
+        waypoint.search = simWaypoint.search;
+        waypoint.gate = simWaypoint.gate;
+        waypoint.gate_width = static_cast<float>( simWaypoint.gateWidth );
+        waypoint.id = static_cast<int16_t>( simWaypoint.id );
+        waypoint.odom = toOdometry( mField, simWaypoint.position );
+        course.waypoints.push_back( waypoint );
+    }
+    mLcmObject.publish( "/course", &course );
+} // publishCourse()
+
+// Publishes everything the rover senses at its current position. The
+// radio signal is always strong, so nav never drops a repeater.
+void NavSimulator::publishSensors()
+{
+    Odometry odometryMessage = odometry();
+    TargetList targetListMessage = targetList();
+    Obstacle obstacleMessage = obstacle();
+    RadioSignalStrength radio;
+    radio.signal_strength = 100;
+    mLcmObject.publish( "/odometry", &odometryMessage );
+    mLcmObject.publish( "/target_list", &targetListMessage );
+    mLcmObject.publish( "/obstacle", &obstacleMessage );
+    mLcmObject.publish( "/radio", &radio );
+} // publishSensors()
+
+// Returns the rover's odometry, without any gps noise.
+Odometry NavSimulator::odometry() const
+{
+    Odometry odometryMessage = toOdometry( mField, mPosition );
+    odometryMessage.bearing_deg = mod( mBearing, 360 );
+    odometryMessage.speed = mSpeed;
+    return odometryMessage;
+} // odometry()
+
+// Returns the two AR tags in view ordered left to right, as the
+// browser simulator does. Missing targets have a distance of -1.
+TargetList NavSimulator::targetList() const
+{
+    vector<Target> visible;
+    for( const SimPost& post : mField.posts )
+    {
+        Relative relative = relativeTo( mPosition, mBearing, post.position );
+        if( relative.distance < mOptions.minTagDistance ||
+            relative.distance > mOptions.visionDistance ||
+            fabs( relative.bearing ) > mOptions.fieldOfView / 2 )
+        {
+            continue;
+        }
+        Target target;
+        target.distance = relative.distance;
+        target.bearing = relative.bearing;
+        target.id = post.id;
+        visible.push_back( target );
+    }
+    sort( visible.begin(), visible.end(), []( const Target& a, const Target& b ) {
+        return a.bearing != b.bearing ? a.bearing < b.bearing : a.distance < b.distance;
+    } );
+
+    TargetList targetListMessage;
+    for( int i = 0; i < 2; ++i )
+    {
+        Target& target = targetListMessage.targetList[ i ];
+        if( i < static_cast<int>( visible.size() ) )
+        {
+            target = visible[ i ];
+        }
+        else
+        {
+            target.distance = -1;
+            target.bearing = 0;
+            target.id = -1;
+        }
+    }
+    return targetListMessage;
+} // targetList()
+
+// Returns what obstacle detection would report, the same way the depth
+// obstacle mode in perception does: the distance to the nearest rock
+// in the corridor straight ahead, or -1 if it is clear, and the
+// smallest turns left (bearing) and right (rightBearing) in one degree
+// steps that give a clear corridor, or the edge of the view if none do.
+Obstacle NavSimulator::obstacle() const
+{
+    double halfCorridor = mStateMachine.config().roverMeasurements.width / 2 + mOptions.obstaclePadding;
+    double halfView = mOptions.fieldOfView / 2;
+
+    // The bearings each rock in view blocks a corridor at.
+    vector<pair<double, double>> blocked;
+    double centerDistance = -1;
+    for( const SimRock& rock : mField.rocks )
+    {
+        Relative relative = relativeTo( mPosition, mBearing, rock.position );
+        double surface = max( 0.0, relative.distance - rock.radius );
+        if( surface > mOptions.visionDistance )
+        {
+            continue;
+        }
+        double spread = relative.distance > halfCorridor + rock.radius
+                        ? radianToDegree( asin( ( halfCorridor + rock.radius ) / relative.distance ) )
+                        : 180;
+        double low = relative.bearing - spread;
+        double high = relative.bearing + spread;
+        if( high < -halfView || low > halfView )
+        {
+            continue;
+        }
+        blocked.emplace_back( low, high );
+        if( low <= 0 && high >= 0 && ( centerDistance < 0 || surface < centerDistance ) )
+        {
+            centerDistance = surface;
+        }
+    }
+
+    Obstacle obstacleMessage;
+    obstacleMessage.distance = centerDistance;
+    obstacleMessage.bearing = 0;
+    obstacleMessage.rightBearing = 0;
+    if( centerDistance < 0 )
+    {
+        return obstacleMessage;
+    }
+
+    auto isClear = [ &blocked ]( const double bearing ) {
+        for( const auto& range : blocked )
+        {
+            if( bearing >= range.first && bearing <= range.second )
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    obstacleMessage.bearing = -halfView;
+    for( double bearing = -1; bearing >= -halfView; bearing -= 1 )
+    {
+        if( isClear( bearing ) )
+        {
+            obstacleMessage.bearing = bearing;
+            break;
+        }
+    }
+    obstacleMessage.rightBearing = halfView;
+    for( double bearing = 1; bearing <= halfView; bearing += 1 )
+    {
+        if( isClear( bearing ) )
+        {
+            obstacleMessage.rightBearing = bearing;
+            break;
+        }
+    }
+    return obstacleMessage;
+} // obstacle()
+
+// Handles every message queued on the in process LCM, which delivers
+// the simulator's messages to nav and nav's to the simulator.
+void NavSimulator::pumpLcm()
+{
+    while( mLcmObject.handleTimeout( 0 ) > 0 )
+    {
+    }
+} // pumpLcm()
+
+// Moves the rover for dt seconds under the last joystick command. The
+// rover drives along an arc, so it moves along the chord of the arc in
+// the direction halfway through the turn. Dampen scales both axes like
+// the drive controller does (-1 is full power, 1 is none).
+void NavSimulator::step( const double dt )
+{
+    double power = mJoystick.kill ? 0 : ( 1 - mJoystick.dampen ) / 2;
+    double distance = dt * mOptions.driveSpeed * clamp( mJoystick.forward_back, -1, 1 ) * power;
+    double turn = dt * mOptions.turnSpeed * clamp( mJoystick.left_right, -1, 1 ) * power;
+
+    double halfTurn = degreeToRadian( fabs( turn ) ) / 2;
+    double chord = halfTurn > 0 ? distance * sin( halfTurn ) / halfTurn : distance;
+    double heading = degreeToRadian( mBearing + turn / 2 );
+    mPosition.x += chord * sin( heading );
+    mPosition.y += chord * cos( heading );
+    mBearing = mod( mBearing + turn, 360 );
+    mSpeed = distance / dt;
+    mResult.distanceDriven += fabs( distance );
+} // step()
+
+// Returns true if any part of the rover's footprint, taken as a circle
+// as wide as the rover, is inside a rock.
+bool NavSimulator::isColliding() const
+{
+    double roverRadius = mStateMachine.config().roverMeasurements.width / 2;
+    for( const SimRock& rock : mField.rocks )
+    {
+        double distance = hypot( rock.position.x - mPosition.x, rock.position.y - mPosition.y );
+        if( distance < rock.radius + roverRadius )
+        {
+            return true;
+        }
+    }
+    return false;
+} // isColliding()
+
+// Keeps the joystick command nav sent for the next step.
+void NavSimulator::joystick(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const Joystick* joystick
+    )
+{
+    mJoystick = *joystick;
+} // joystick()
+
+// Keeps nav's status to tell when the mission is done.
+void NavSimulator::navStatus(
+    const lcm::ReceiveBuffer* receiveBuffer,
+    const string& channel,
+    const NavStatus* navStatus
+    )
+{
+    mNavStatus = *navStatus;
+} // navStatus()
@@ -0,0 +1,143 @@
+#ifndef NAV_SIMULATOR_HPP
+#define NAV_SIMULATOR_HPP
+
+#include <lcm/lcm-cpp.hpp>
+#include <string>
+
+#include "lcmReceiver.hpp"
+#include "simField.hpp"
+#include "stateMachine.hpp"
+#include "rover_msgs/Joystick.hpp"
+#include "rover_msgs/NavStatus.hpp"
+
+using namespace rover_msgs;
+using namespace std;
+
+// How the simulated rover moves and sees. The defaults match the
+// browser simulator.
+struct SimOptions
+{
+    // Seconds of simulated time before a mission counts as failed.
+    double timeLimit = 600;
+
+    // Speed at full joystick, in meters and degrees per second.
+    double driveSpeed = 2;
+    double turnSpeed = 30;
+
+    // The ZED's field of view, in degrees across, and how far away in
+    // meters it sees AR tags and rocks.
+    double fieldOfView = 110;
+    double visionDistance = 3;
+
+    // The closest an AR tag can be and still be seen, in meters.
+    double minTagDistance = 0.25;
+
+    // Clearance the obstacle detector wants on each side of the rover,
+    // in meters.
+    double obstaclePadding = 0.25;
+};
+
+// How a simulated mission went.
+struct SimResult
+{
+    // True if nav reached Done within the time limit.
+    bool completed;
+
+    // Simulated seconds from turning auton on to Done, or to the time
+    // limit.
+    double missionTime;
+
+    int completedWaypoints;
+    int totalWaypoints;
+
+    // Meters driven, counting both directions.
+    double distanceDriven;
+
+    // Times the rover ran into a rock.
+    int collisions;
+
+    // Control ticks run, and the real seconds they took.
+    long ticks;
+    double wallTime;
+};
+
+// Runs the real nav state machine against a simulated rover and field
+// in lockstep. Nav and the simulator share an in process memq:// LCM,
+// so nav sees exactly the messages it would on the rover, and every
+// control tick the simulator publishes the rover's odometry and what
+// perception would see, lets nav run one tick and then applies the
+// joystick command nav published to the rover. Time is simulated, so
+// a mission runs as fast as the CPU allows.
+//
+// Nav keeps some state in statics and reads time through a process
+// wide clock, so only one NavSimulator may exist at a time and a
+// process should run a single mission.
+class NavSimulator
+{
+public:
+    NavSimulator( const SimField& field, const SimOptions& options );
+
+    ~NavSimulator();
+
+    SimResult run();
+
+private:
+    /*************************************************************************/
+    /* Private Member Functions */
+    /*************************************************************************/
+    void publishCourse();
+
+    void publishSensors();
+
+    Odometry odometry() const;
+
+    TargetList targetList() const;
+
+    Obstacle obstacle() const;
+
+    void pumpLcm();
+
+    void step( double dt );
+
+    bool isColliding() const;
+
+    void joystick( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                   const Joystick* joystick );
+
+    void navStatus( const lcm::ReceiveBuffer* receiveBuffer, const string& channel,
+                    const NavStatus* navStatus );
+
+    /*************************************************************************/
+    /* Private Member Variables */
+    /*************************************************************************/
+    // The field being driven on.
+    const SimField& mField;
+
+    const SimOptions mOptions;
+
+    // The in process LCM nav and the simulator talk over.
+    lcm::LCM mLcmObject;
+
+    // The nav code under test.
+    StateMachine mStateMachine;
+    LcmReceiver mReceiver;
+
+    // The rover's position on the field, its bearing in degrees from
+    // north and its current speed in meters per second.
+    SimPoint mPosition;
+    double mBearing;
+    double mSpeed;
+
+    // The last joystick command nav published.
+    Joystick mJoystick;
+
+    // The last nav status nav published.
+    NavStatus mNavStatus;
+
+    // Whether the rover was inside a rock on the last step.
+    bool mColliding;
+
+    SimResult mResult;
+}; // NavSimulator
+
+#endif // NAV_SIMULATOR_HPP
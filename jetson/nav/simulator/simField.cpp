@@ -0,0 +1,329 @@
+#include "simField.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "rapidjson/document.h"
+#include "localFrame.hpp"
+#include "rapidjson/error/en.h"
+#include "utilities.hpp"
+
+namespace
+{
+    // Reads typed values out of one object of a field file, remembering
+    // the first key that was missing or had the wrong type. Optional
+    // keys keep the value they already have when missing.
+    class FieldReader
+    {
+    public:
+        FieldReader( string& error )
+            : mError( error )
+        {}
+
+        bool ok() const
+        {
+            return mError.empty();
+        }
+
+        void read( const rapidjson::Value& object, const string& where, const char* key,
+                   double& out, bool optional = false )
+        {
+            const rapidjson::Value* value = find( object, where, key, optional );
+            if( !value )
+            {
+                return;
+            }
+            if( !value->IsNumber() )
+            {
+                fail( where, key, "a number" );
+                return;
+            }
+            out = value->GetDouble();
+        }
+
+        void read( const rapidjson::Value& object, const string& where, const char* key,
+                   int& out, bool optional = false )
+        {
+            const rapidjson::Value* value = find( object, where, key, optional );
+            if( !value )
+            {
+                return;
+            }
+            if( !value->IsInt() )
+            {
+                fail( where, key, "an integer" );
+                return;
+            }
+            out = value->GetInt();
+        }
+
+        void read( const rapidjson::Value& object, const string& where, const char* key,
+                   bool& out, bool optional = false )
+        {
+            const rapidjson::Value* value = find( object, where, key, optional );
+            if( !value )
+            {
+                return;
+            }
+            if( !value->IsBool() )
+            {
+                fail( where, key, "true or false" );
+                return;
+            }
+            out = value->GetBool();
+        }
+
+        void read( const rapidjson::Value& object, const string& where, SimPoint& out )
+        {
+            read( object, where, "x", out.x );
+            read( object, where, "y", out.y );
+        }
+
+        // Returns the array under key, or nullptr if it is missing,
+        // which counts as empty.
+        const rapidjson::Value* array( const rapidjson::Value& object, const char* key )
+        {
+            const rapidjson::Value* value = find( object, "field", key, true );
+            if( value && !value->IsArray() )
+            {
+                fail( "field", key, "an array" );
+                return nullptr;
+            }
+            return value;
+        }
+
+        // Returns the element of an array as an object.
+        const rapidjson::Value* element( const rapidjson::Value& value, const string& where )
+        {
+            if( !ok() )
+            {
+                return nullptr;
+            }
+            if( !value.IsObject() )
+            {
+                mError = where + " must be an object";
+                return nullptr;
+            }
+            return &value;
+        }
+
+        // Records a check on the values that the types alone don't catch.
+        void require( bool condition, const string& message )
+        {
+            if( ok() && !condition )
+            {
+                mError = message;
+            }
+        }
+
+    private:
+        const rapidjson::Value* find( const rapidjson::Value& object, const string& where,
+                                      const char* key, bool optional )
+        {
+            if( !ok() )
+            {
+                return nullptr;
+            }
+            auto keyIt = object.FindMember( key );
+            if( keyIt == object.MemberEnd() )
+            {
+                if( !optional )
+                {
+                    mError = "missing " + where + "/" + key;
+                }
+                return nullptr;
+            }
+            return &keyIt->value;
+        }
+
+        void fail( const string& where, const char* key, const char* expected )
+        {
+            mError = where + "/" + key + " must be " + expected;
+        }
+
+        string& mError;
+    };
+
+    // Splits decimal degrees into the whole degrees and minutes
+    // Odometry holds. Both parts share the sign.
+    void splitDegrees( const double degrees, int32_t& wholeDegrees, double& minutes )
+    {
+        wholeDegrees = static_cast<int32_t>( trunc( degrees ) );
+        minutes = ( degrees - wholeDegrees ) * 60;
+    } // splitDegrees()
+} // namespace
+
+bool parseSimField( const string& text, SimField& field, string& error )
+{
+    rapidjson::Document document;
+    document.Parse( text.c_str() );
+    if( document.HasParseError() )
+    {
+        error = string( "json error at offset " ) + to_string( document.GetErrorOffset() ) + ": " +
+                rapidjson::GetParseError_En( document.GetParseError() );
+        return false;
+    }
+    if( !document.IsObject() )
+    {
+        error = "field must be a json object";
+        return false;
+    }
+
+    SimField parsed;
+    error.clear();
+    FieldReader reader( error );
+
+    // The origin is given in decimal degrees, which is how field
+    // coordinates are usually written down.
+    auto originIt = document.FindMember( "origin" );
+    reader.require( originIt != document.MemberEnd() && originIt->value.IsObject(),
+                    "missing section origin" );
+    if( reader.ok() )
+    {
+        double latitude = 0;
+        double longitude = 0;
+        reader.read( originIt->value, "origin", "latitude", latitude );
+        reader.read( originIt->value, "origin", "longitude", longitude );
+        splitDegrees( latitude, parsed.origin.latitude_deg, parsed.origin.latitude_min );
+        splitDegrees( longitude, parsed.origin.longitude_deg, parsed.origin.longitude_min );
+        parsed.origin.bearing_deg = 0;
+        parsed.origin.speed = 0;
+    }
+
+    auto startIt = document.FindMember( "start" );
+    reader.require( startIt != document.MemberEnd() && startIt->value.IsObject(),
+                    "missing section start" );
+    if( reader.ok() )
+    {
+        parsed.startBearing = 0;
+        reader.read( startIt->value, "start", parsed.start );
+        reader.read( startIt->value, "start", "bearing", parsed.startBearing, true );
+    }
+
+    if( const rapidjson::Value* waypoints = reader.array( document, "waypoints" ) )
+    {
+        for( rapidjson::SizeType i = 0; i < waypoints->Size(); ++i )
+        {
+            string where = "waypoints/" + to_string( i );
+            const rapidjson::Value* object = reader.element( ( *waypoints )[ i ], where );
+            if( !object )
+            {
+                break;
+            }
+            SimWaypoint waypoint;
+            waypoint.search = false;
+            waypoint.gate = false;
+            waypoint.gateWidth = 0;
+            waypoint.id = -1;
+            reader.read( *object, where, waypoint.position );
+            reader.read( *object, where, "search", waypoint.search, true );
+            reader.read( *object, where, "gate", waypoint.gate, true );
+            reader.read( *object, where, "gate_width", waypoint.gateWidth, !waypoint.gate );
+            reader.read( *object, where, "id", waypoint.id, true );
+            parsed.waypoints.push_back( waypoint );
+        }
+    }
+
+    if( const rapidjson::Value* posts = reader.array( document, "posts" ) )
+    {
+        for( rapidjson::SizeType i = 0; i < posts->Size(); ++i )
+        {
+            string where = "posts/" + to_string( i );
+            const rapidjson::Value* object = reader.element( ( *posts )[ i ], where );
+            if( !object )
+            {
+                break;
+            }
+            SimPost post;
+            reader.read( *object, where, post.position );
+            reader.read( *object, where, "id", post.id );
+            parsed.posts.push_back( post );
+        }
+    }
+
+    // A gate is given by its center, its width and the bearing from
+    // its left post to its right post.
+    if( const rapidjson::Value* gates = reader.array( document, "gates" ) )
+    {
+        for( rapidjson::SizeType i = 0; i < gates->Size(); ++i )
+        {
+            string where = "gates/" + to_string( i );
+            const rapidjson::Value* object = reader.element( ( *gates )[ i ], where );
+            if( !object )
+            {
+                break;
+            }
+            SimPoint center = { 0, 0 };
+            double width = 0;
+            double orientation = 0;
+            SimPost left;
+            SimPost right;
+            reader.read( *object, where, center );
+            reader.read( *object, where, "width", width );
+            reader.read( *object, where, "orientation", orientation );
+            reader.read( *object, where, "left_id", left.id );
+            reader.read( *object, where, "right_id", right.id );
+            reader.require( width > 0, where + "/width must be positive" );
+
+            double angle = degreeToRadian( orientation );
+            double dx = sin( angle ) * width / 2;
+            double dy = cos( angle ) * width / 2;
+            left.position = { center.x - dx, center.y - dy };
+            right.position = { center.x + dx, center.y + dy };
+            parsed.posts.push_back( left );
+            parsed.posts.push_back( right );
+        }
+    }
+
+    if( const rapidjson::Value* rocks = reader.array( document, "rocks" ) )
+    {
+        for( rapidjson::SizeType i = 0; i < rocks->Size(); ++i )
+        {
+            string where = "rocks/" + to_string( i );
+            const rapidjson::Value* object = reader.element( ( *rocks )[ i ], where );
+            if( !object )
+            {
+                break;
+            }
+            SimRock rock;
+            reader.read( *object, where, rock.position );
+            reader.read( *object, where, "radius", rock.radius );
+            reader.require( rock.radius > 0, where + "/radius must be positive" );
+            parsed.rocks.push_back( rock );
+        }
+    }
+
+    if( !reader.ok() )
+    {
+        return false;
+    }
+    field = parsed;
+    return true;
+} // parseSimField()
+
+bool loadSimField( const string& path, SimField& field, string& error )
+{
+    ifstream fieldFile( path );
+    if( !fieldFile )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    stringstream text;
+    text << fieldFile.rdbuf();
+    if( !parseSimField( text.str(), field, error ) )
+    {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+} // loadSimField()
+
+Odometry toOdometry( const SimField& field, const SimPoint& point )
+{
+    LocalFrame frame;
+    frame.anchor( field.origin );
+    LocalPoint localPoint = { point.x, point.y };
+    return frame.toOdometry( localPoint );
+} // toOdometry()
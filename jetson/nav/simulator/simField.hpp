@@ -0,0 +1,72 @@
+#ifndef SIM_FIELD_HPP
+#define SIM_FIELD_HPP
+
+#include <string>
+#include <vector>
+
+#include "rover_msgs/Odometry.hpp"
+
+using namespace rover_msgs;
+using namespace std;
+
+// A spot on the field in meters east (x) and north (y) of the field's
+// origin.
+struct SimPoint
+{
+    double x;
+    double y;
+};
+
+// A waypoint of the course the rover is given.
+struct SimWaypoint
+{
+    SimPoint position;
+    bool search;
+    bool gate;
+    double gateWidth;
+    int id;
+};
+
+// A post with an AR tag on it, either alone or one side of a gate.
+struct SimPost
+{
+    SimPoint position;
+    int id;
+};
+
+// A rock the rover has to drive around.
+struct SimRock
+{
+    SimPoint position;
+    double radius;
+};
+
+// Everything the simulated rover can drive to, see or hit. Gates in
+// the field file are stored as their two posts.
+struct SimField
+{
+    // The GPS position of the field's origin.
+    Odometry origin;
+
+    // Where the rover starts and which way it faces, in degrees from
+    // north.
+    SimPoint start;
+    double startBearing;
+
+    vector<SimWaypoint> waypoints;
+    vector<SimPost> posts;
+    vector<SimRock> rocks;
+};
+
+// Parses the json text of a field file into field. On failure field is
+// left untouched and error says what was wrong.
+bool parseSimField( const string& text, SimField& field, string& error );
+
+// Reads and parses the field file at path, see parseSimField.
+bool loadSimField( const string& path, SimField& field, string& error );
+
+// Converts a point on the field to GPS. The field is a LocalFrame
+// around the origin, the same equirectangular approximation nav works in.
+Odometry toOdometry( const SimField& field, const SimPoint& point );
+
+#endif // SIM_FIELD_HPP
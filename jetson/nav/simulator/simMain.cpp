@@ -0,0 +1,131 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "navSimulator.hpp"
+
+using namespace std;
+
+namespace
+{
+    void printUsage()
+    {
+        cerr << "usage: jetson_nav_sim <field.json> [--time-limit S] [--drive-speed M/S]\n"
+             << "                      [--turn-speed DEG/S] [--fov DEG] [--vision-distance M]\n"
+             << "                      [--output result.json]\n";
+    } // printUsage()
+
+    // Reads the number after a flag. Returns false if it is missing or
+    // not a positive number.
+    bool readPositive( int argc, char** argv, int& i, double& out )
+    {
+        if( i + 1 >= argc )
+        {
+            return false;
+        }
+        char* end = nullptr;
+        out = strtod( argv[ ++i ], &end );
+        return *end == '\0' && out > 0;
+    } // readPositive()
+
+    string toJson( const SimResult& result )
+    {
+        stringstream json;
+        json << "{\n"
+             << "  \"completed\": " << ( result.completed ? "true" : "false" ) << ",\n"
+             << "  \"mission_time_s\": " << result.missionTime << ",\n"
+             << "  \"completed_waypoints\": " << result.completedWaypoints << ",\n"
+             << "  \"total_waypoints\": " << result.totalWaypoints << ",\n"
+             << "  \"distance_driven_m\": " << result.distanceDriven << ",\n"
+             << "  \"collisions\": " << result.collisions << ",\n"
+             << "  \"ticks\": " << result.ticks << ",\n"
+             << "  \"wall_time_s\": " << result.wallTime << ",\n"
+             << "  \"speedup\": " << ( result.wallTime > 0 ? result.missionTime / result.wallTime : 0 ) << "\n"
+             << "}\n";
+        return json.str();
+    } // toJson()
+} // namespace
+
+// Runs one simulated mission and prints how it went as json. Exits
+// with 0 if the mission was completed, 1 if it was not and 2 on bad
+// arguments or a bad field file.
+int main( int argc, char** argv )
+{
+    string fieldPath;
+    string outputPath;
+    SimOptions options;
+    for( int i = 1; i < argc; ++i )
+    {
+        bool ok = true;
+        if( !strcmp( argv[ i ], "--time-limit" ) )
+        {
+            ok = readPositive( argc, argv, i, options.timeLimit );
+        }
+        else if( !strcmp( argv[ i ], "--drive-speed" ) )
+        {
+            ok = readPositive( argc, argv, i, options.driveSpeed );
+        }
+        else if( !strcmp( argv[ i ], "--turn-speed" ) )
+        {
+            ok = readPositive( argc, argv, i, options.turnSpeed );
+        }
+        else if( !strcmp( argv[ i ], "--fov" ) )
+        {
+            ok = readPositive( argc, argv, i, options.fieldOfView );
+        }
+        else if( !strcmp( argv[ i ], "--vision-distance" ) )
+        {
+            ok = readPositive( argc, argv, i, options.visionDistance );
+        }
+        else if( !strcmp( argv[ i ], "--output" ) && i + 1 < argc )
+        {
+            outputPath = argv[ ++i ];
+        }
+        else if( argv[ i ][ 0 ] != '-' && fieldPath.empty() )
+        {
+            fieldPath = argv[ i ];
+        }
+        else
+        {
+            ok = false;
+        }
+        if( !ok )
+        {
+            printUsage();
+            return 2;
+        }
+    }
+    if( fieldPath.empty() )
+    {
+        printUsage();
+        return 2;
+    }
+
+    SimField field;
+    string error;
+    if( !loadSimField( fieldPath, field, error ) )
+    {
+        cerr << "Error: " << error << endl;
+        return 2;
+    }
+
+    NavSimulator simulator( field, options );
+    SimResult result = simulator.run();
+
+    string json = toJson( result );
+    cout << json;
+    if( !outputPath.empty() )
+    {
+        ofstream output( outputPath );
+        output << json;
+        if( !output )
+        {
+            cerr << "Error: cannot write " << outputPath << endl;
+            return 2;
+        }
+    }
+    return result.completed ? 0 : 1;
+} // main()
@@ -6,6 +6,7 @@
 #include <sstream>
 #include <cmath>
 #include <cstdlib>
+#include <cassert>
 #include <map>
 
 #include "rover_msgs/NavStatus.hpp"
@@ -28,18 +29,12 @@ StateMachine::StateMachine( lcm::LCM& lcmObject )
     , mRepeaterDropComplete ( false )
     , mStateChanged( true )
 {
-    ifstream configFile;
-    string configPath = getenv("MROVER_CONFIG");
-    configPath += "/config_nav/config.json";
-    configFile.open( configPath );
-    string config = "";
-    string setting;
-    while( configFile >> setting )
+    string error;
+    if( !loadNavConfig( navConfigPath(), mRoverConfig, error ) )
     {
-        config += setting;
+        cerr << "Error: " << error << endl;
+        exit( 1 );
     }
-    configFile.close();
-    mRoverConfig.Parse( config.c_str() );
     mRover = new Rover( mRoverConfig, lcmObject );
     mSearchStateMachine = SearchFactory( this, SearchType::SPIRALOUT, mRover, mRoverConfig );
     mGateStateMachine = GateFactory( this, mRover, mRoverConfig );
@@ -53,7 +48,42 @@ StateMachine::~StateMachine( )
     delete mRover;
 }
 
-void StateMachine::setSearcher( SearchType type, Rover* rover, const rapidjson::Document& roverConfig )
+// Replaces the configuration with the json text in config, or with
+// the config file on disk if config is empty. Everything reads the
+// configuration through a reference, so new values are used from the
+// next iteration of run. A config that fails to parse is ignored and
+// the current one is kept.
+void StateMachine::reloadConfig( const string& config )
+{
+    NavConfig newConfig;
+    string error;
+    bool loaded = config.empty() ? loadNavConfig( navConfigPath(), newConfig, error )
+                                 : parseNavConfig( config, newConfig, error );
+    if( !loaded )
+    {
+        cerr << "Config reload rejected: " << error << endl;
+        return;
+    }
+    mRoverConfig = newConfig;
+    mRover->updateConfig();
+    cout << "Config reloaded" << endl;
+} // reloadConfig()
+
+// Returns the channel config reloads are requested on. It is only read
+// at startup, so changing it takes a restart.
+const string& StateMachine::configChannel() const
+{
+    return mRoverConfig.lcmChannels.configChannel;
+} // configChannel()
+
+// Returns the current configuration, for settings that are read
+// outside the state machine at startup, like the control loop rate.
+const NavConfig& StateMachine::config() const
+{
+    return mRoverConfig;
+} // config()
+
+void StateMachine::setSearcher( SearchType type, Rover* rover, const NavConfig& roverConfig )
 {
     assert( mSearchStateMachine );
     delete mSearchStateMachine;
@@ -176,9 +206,9 @@ void StateMachine::run()
             case NavState::ChangeSearchAlg:
             {
                 static int searchFails = 0;
-                static double visionDistance = mRoverConfig[ "computerVision" ][ "visionDistance" ].GetDouble();
+                double visionDistance = mRoverConfig.computerVision.visionDistance;
 
-                switch( mRoverConfig[ "search" ][ "order" ][ searchFails % mRoverConfig[ "search" ][ "numSearches" ].GetInt() ].GetInt() )
+                switch( mRoverConfig.search.order[ searchFails % mRoverConfig.search.numSearches ] )
                 {
                     case 0:
                     {
@@ -244,50 +274,57 @@ void StateMachine::run()
 } // run()
 
 // Updates the auton state (on/off) of the rover's status.
-void StateMachine::updateRoverStatus( AutonState autonState )
+void StateMachine::updateRoverStatus( const AutonState& autonState )
 {
     mNewRoverStatus.autonState() = autonState;
+    mNewRoverStatus.markChanged( Rover::RoverStatus::AutonStateField );
 } // updateRoverStatus( AutonState )
 
-// Updates the course of the rover's status if it has changed.
-void StateMachine::updateRoverStatus( Course course )
+// Updates the course of the rover's status if it has changed. The
+// course is republished constantly, so comparing hashes keeps the
+// waypoints from being copied on every message.
+void StateMachine::updateRoverStatus( const Course& course )
 {
     if( mNewRoverStatus.course().hash != course.hash )
     {
         mNewRoverStatus.course() = course;
+        mNewRoverStatus.markChanged( Rover::RoverStatus::CourseField );
     }
 } // updateRoverStatus( Course )
 
 // Updates the obstacle information of the rover's status.
-void StateMachine::updateRoverStatus( Obstacle obstacle )
+void StateMachine::updateRoverStatus( const Obstacle& obstacle )
 {
     mNewRoverStatus.obstacle() = obstacle;
+    mNewRoverStatus.markChanged( Rover::RoverStatus::ObstacleField );
 } // updateRoverStatus( Obstacle )
 
 // Updates the odometry information of the rover's status.
-void StateMachine::updateRoverStatus( Odometry odometry )
+void StateMachine::updateRoverStatus( const Odometry& odometry )
 {
     mNewRoverStatus.odometry() = odometry;
+    mNewRoverStatus.markChanged( Rover::RoverStatus::OdometryField );
 } // updateRoverStatus( Odometry )
 
 // Updates the target information of the rover's status.
-void StateMachine::updateRoverStatus( TargetList targetList )
+void StateMachine::updateRoverStatus( const TargetList& targetList )
 {
-    Target target1 = targetList.targetList[0];
-    Target target2 = targetList.targetList[1];
-    mNewRoverStatus.target() = target1;
-    mNewRoverStatus.target2() = target2;
+    mNewRoverStatus.target() = targetList.targetList[0];
+    mNewRoverStatus.target2() = targetList.targetList[1];
+    mNewRoverStatus.markChanged( Rover::RoverStatus::TargetsField );
 } // updateRoverStatus( Target )
 
 // Updates the radio signal strength information of the rover's status.
-void StateMachine::updateRoverStatus( RadioSignalStrength radioSignalStrength )
+void StateMachine::updateRoverStatus( const RadioSignalStrength& radioSignalStrength )
 {
     mNewRoverStatus.radio() = radioSignalStrength;
+    mNewRoverStatus.markChanged( Rover::RoverStatus::RadioField );
 } // updateRoverStatus( RadioSignalStrength )
 
 // Return true if we want to execute a loop in the state machine, false
-// otherwise.
-bool StateMachine::isRoverReady() const
+// otherwise. Hands the rover the parts of the status that changed
+// since the last loop.
+bool StateMachine::isRoverReady()
 {
     return mStateChanged || // internal data has changed
            mRover->updateRover( mNewRoverStatus ) || // external data has changed
@@ -305,7 +342,7 @@ void StateMachine::publishNavState() const
     navStatus.nav_state_name = stringifyNavState();
     navStatus.completed_wps = mCompletedWaypoints;
     navStatus.total_wps = mTotalWaypoints;
-    const string& navStatusChannel = mRoverConfig[ "lcmChannels" ][ "navStatusChannel" ].GetString();
+    const string& navStatusChannel = mRoverConfig.lcmChannels.navStatusChannel;
     mLcmObject.publish( navStatusChannel, &navStatus );
 } // publishNavState()
 
@@ -355,7 +392,7 @@ NavState StateMachine::executeTurn()
         return NavState::RadioRepeaterTurn;
     }
 
-    Odometry& nextPoint = mRover->roverStatus().path().front().odom;
+    const LocalPoint& nextPoint = mRover->roverStatus().path().front().position;
     if( mRover->turn( nextPoint ) )
     {
         if (mRover->roverStatus().currentState() == NavState::RadioRepeaterTurn)
@@ -380,8 +417,8 @@ NavState StateMachine::executeTurn()
 // it goes to turn around it. Else the rover keeps driving to the next Waypoint.
 NavState StateMachine::executeDrive()
 {
-    const Waypoint& nextWaypoint = mRover->roverStatus().path().front();
-    double distance = estimateNoneuclid( mRover->roverStatus().odometry(), nextWaypoint.odom );
+    const LocalWaypoint& nextWaypoint = mRover->roverStatus().path().front();
+    double distance = calcDistance( mRover->roverStatus().position(), nextWaypoint.position );
 
     // If we should drop a repeater and have not already, add last
     // point where connection was good to front of path and turn
@@ -398,7 +435,7 @@ NavState StateMachine::executeDrive()
                                                                 getOptimalAvoidanceDistance() );
         return NavState::TurnAroundObs;
     }
-    DriveStatus driveStatus = mRover->drive( nextWaypoint.odom );
+    DriveStatus driveStatus = mRover->drive( nextWaypoint.position );
     if( driveStatus == DriveStatus::Arrived )
     {
         if( nextWaypoint.search )
@@ -437,7 +474,7 @@ NavState StateMachine::executeRepeaterDropWait( )
 {
 
     RepeaterDrop rr_init;
-    const string& radioRepeaterInitChannel = mRoverConfig[ "lcmChannels" ][ "repeaterDropInitChannel" ].GetString();
+    const string& radioRepeaterInitChannel = mRoverConfig.lcmChannels.repeaterDropInitChannel;
     mLcmObject.publish( radioRepeaterInitChannel, &rr_init );
 
     if( mRepeaterDropComplete )
@@ -496,12 +533,12 @@ double StateMachine::getOptimalAvoidanceAngle() const
 // Returns the optimal angle to avoid the detected obstacle.
 double StateMachine::getOptimalAvoidanceDistance() const
 {
-    return mRover->roverStatus().obstacle().distance + mRoverConfig[ "navThresholds" ][ "waypointDistance" ].GetDouble();
+    return mRover->roverStatus().obstacle().distance + mRoverConfig.navThresholds.waypointDistance;
 } // optimalAvoidanceAngle()
 
 bool StateMachine::isWaypointReachable( double distance )
 {
-    return isLocationReachable( mRover, mRoverConfig, distance, mRoverConfig["navThresholds"]["waypointDistance"].GetDouble());
+    return isLocationReachable( mRover, mRoverConfig, distance, mRoverConfig.navThresholds.waypointDistance);
 } // isWaypointReachable
 
 // If we have not already begun to drop radio repeater
@@ -527,7 +564,7 @@ void StateMachine::addRepeaterDropPoint()
     way.search = false;
     way.gate = false;
 
-    mRover->roverStatus().path().push_front(way);
+    mRover->roverStatus().path().emplace_front( way, mRover->frame().toLocal( way.odom ) );
 } // addRepeaterDropPoint
 
 // TODOS:
@@ -2,7 +2,7 @@
 #define STATE_MACHINE_HPP
 
 #include <lcm/lcm-cpp.hpp>
-#include "rapidjson/document.h"
+#include "navConfig.hpp"
 #include "rover.hpp"
 #include "search/searchStateMachine.hpp"
 #include "gate_search/gateStateMachine.hpp"
@@ -25,19 +25,19 @@ public:
 
     void run( );
 
-    void updateRoverStatus( AutonState autonState );
+    void updateRoverStatus( const AutonState& autonState );
 
-    void updateRoverStatus( Bearing bearing );
+    void updateRoverStatus( const Bearing& bearing );
 
-    void updateRoverStatus( Course course );
+    void updateRoverStatus( const Course& course );
 
-    void updateRoverStatus( Obstacle obstacle );
+    void updateRoverStatus( const Obstacle& obstacle );
 
-    void updateRoverStatus( Odometry odometry );
+    void updateRoverStatus( const Odometry& odometry );
 
-    void updateRoverStatus( TargetList targetList );
+    void updateRoverStatus( const TargetList& targetList );
 
-    void updateRoverStatus( RadioSignalStrength radioSignalStrength );
+    void updateRoverStatus( const RadioSignalStrength& radioSignalStrength );
 
     void updateCompletedPoints( );
 
@@ -49,7 +49,13 @@ public:
 
     void updateRepeaterComplete( );
 
-    void setSearcher(SearchType type, Rover* rover, const rapidjson::Document& roverConfig );
+    void reloadConfig( const string& config );
+
+    const string& configChannel() const;
+
+    const NavConfig& config() const;
+
+    void setSearcher(SearchType type, Rover* rover, const NavConfig& roverConfig );
 
     /*************************************************************************/
     /* Public Member Variables */
@@ -61,7 +67,7 @@ private:
     /*************************************************************************/
     /* Private Member Functions */
     /*************************************************************************/
-    bool isRoverReady() const;
+    bool isRoverReady();
 
     void publishNavState() const;
 
@@ -106,7 +112,7 @@ private:
     lcm::LCM& mLcmObject;
 
     // Configuration file for the rover.
-    rapidjson::Document mRoverConfig;
+    NavConfig mRoverConfig;
 
     // Number of waypoints in course.
     unsigned mTotalWaypoints;
@@ -1,7 +1,14 @@
 #include "utilities.hpp"
 #include <iostream> // remove
+#include <chrono>
 #include <cmath>
 
+namespace
+{
+    // The clock set with setNavClock, or nullptr for the system clock.
+    double ( *navClock )() = nullptr;
+} // namespace
+
 // Coverts the input degree (and optional minute) to radians.
 double degreeToRadian( const double degree, const double minute )
 {
@@ -14,78 +21,30 @@ double radianToDegree( const double radian )
     return radian * 180 / PI;
 }
 
-// create a new odom with coordinates offset from current odom by a certain lat and lon change
-Odometry addMinToDegrees( const Odometry & current, const double lat_minutes, const double lon_minutes )
+// Calculates the distance in meters between two points in the local
+// frame.
+double calcDistance( const LocalPoint& start, const LocalPoint& dest )
 {
-    Odometry newOdom = current;
-    double total_lat_min = current.latitude_min + lat_minutes;
-    int sign_lat = total_lat_min < 0 ? -1 : 1;
-    newOdom.latitude_min = mod( fabs( total_lat_min ), 60 ) * sign_lat;
-    newOdom.latitude_deg += ( total_lat_min ) / 60;
-    double total_lon_min = current.longitude_min + lon_minutes;
-    int sign_lon = total_lon_min < 0 ? -1 : 1;
-    newOdom.longitude_min = mod( fabs( total_lon_min ), 60 ) * sign_lon;
-    newOdom.longitude_deg += ( total_lon_min )/60;
-
-    return newOdom;
-}
+    return hypot( dest.east - start.east, dest.north - start.north );
+} // calcDistance()
 
-// Caclulates the non-euclidean distance between the current odometry and the
-// destination odometry.
-double estimateNoneuclid( const Odometry& current, const Odometry& dest )
+// Calculates the bearing in degrees from start to dest, clockwise from
+// north.
+double calcBearing( const LocalPoint& start, const LocalPoint& dest )
 {
-    double currentLat = degreeToRadian( current.latitude_deg, current.latitude_min );
-    double currentLon = degreeToRadian( current.longitude_deg, current.longitude_min );
-    double destLat = degreeToRadian( dest.latitude_deg, dest.latitude_min );
-    double destLon = degreeToRadian( dest.longitude_deg, dest.longitude_min );
-
-    double diffLat = ( destLat - currentLat );
-    double diffLon = ( destLon - currentLon ) * cos( ( currentLat + destLat ) / 2 );
-    return sqrt( diffLat * diffLat + diffLon * diffLon ) * EARTH_RADIUS;
-}
+    double bearing = radianToDegree( atan2( dest.east - start.east, dest.north - start.north ) );
+    return mod( bearing, 360 );
+} // calcBearing()
 
-// create a new Odometry point at a bearing and distance from a given odometry point
+// Creates a new point at a bearing and distance from the current point.
 // Note this uses the absolute bearing not a bearing relative to the rover.
-Odometry createOdom( const Odometry & current, double bearing, const double distance, Rover * rover )
-{
-    bearing = degreeToRadian( bearing );
-    double latChange = distance * cos( bearing ) * LAT_METER_IN_MINUTES;
-    double lonChange = distance * sin( bearing  ) * rover->longMeterInMinutes();
-    Odometry newOdom = addMinToDegrees( current, latChange, lonChange );
-    return newOdom;
-}
-
-// Caclulates the bearing between the current odometry and the
-// destination odometry.
-double calcBearing( const Odometry& start, const Odometry& dest )
+LocalPoint createPoint( const LocalPoint& current, const double bearing, const double distance )
 {
-    double currentLat = degreeToRadian( start.latitude_deg, start.latitude_min );
-    double currentLon = degreeToRadian( start.longitude_deg, start.longitude_min );
-    double destLat = degreeToRadian( dest.latitude_deg, dest.latitude_min );
-    double destLon = degreeToRadian( dest.longitude_deg, dest.longitude_min );
-
-    double verticleComponentDist = EARTH_RADIUS * sin( destLat - currentLat );
-    double noneuclidDist = estimateNoneuclid( start, dest );
-
-    double bearing = acos( verticleComponentDist / noneuclidDist );
-    if( currentLon > destLon )
-    {
-        bearing = 2 * PI - bearing;
-    }
-
-    if( verticleComponentDist < 0.001 && verticleComponentDist > -0.001 )
-    {
-        if( currentLon < destLon )
-        {
-            bearing = PI / 2;
-        }
-        else
-        {
-            bearing = 3 * PI / 2;
-        }
-    }
-    return radianToDegree( bearing );
-} // calcBearing()
+    LocalPoint newPoint;
+    newPoint.east = current.east + distance * sin( degreeToRadian( bearing ) );
+    newPoint.north = current.north + distance * cos( degreeToRadian( bearing ) );
+    return newPoint;
+} // createPoint()
 
 // // Calculates the modulo of degree with the given modulus.
 double mod( const double degree, const int modulus )
@@ -116,9 +75,9 @@ void throughZero( double& destinationBearing, const double currentBearing )
 } // throughZero()
 
 // Clears the queue.
-void clear( deque<Waypoint>& aDeque )
+void clear( deque<LocalWaypoint>& aDeque )
 {
-    deque<Waypoint> emptyDeque;
+    deque<LocalWaypoint> emptyDeque;
     swap( aDeque, emptyDeque );
 } // clear()
 
@@ -126,17 +85,17 @@ void clear( deque<Waypoint>& aDeque )
 // Checks to see if target is reachable before hitting obstacle
 // If the x component of the distance to obstacle is greater than
 // half the width of the rover the obstacle if reachable
-bool isTargetReachable( Rover* rover, const rapidjson::Document& roverConfig )
+bool isTargetReachable( Rover* rover, const NavConfig& roverConfig )
 {
     double distToTarget = rover->roverStatus().target().distance;
-    double distThresh = roverConfig["navThresholds"]["targetDistance"].GetDouble();
+    double distThresh = roverConfig.navThresholds.targetDistance;
     return isLocationReachable( rover, roverConfig, distToTarget, distThresh );
 } // istargetReachable()
 
 // Returns true if the rover can reach the input location without hitting the obstacle.
 // ASSUMPTION: There is an obstacle detected.
 // ASSUMPTION: The rover is driving straight.
-bool isLocationReachable( Rover* rover, const rapidjson::Document& roverConfig, const double locDist, const double distThresh )
+bool isLocationReachable( Rover* rover, const NavConfig& roverConfig, const double locDist, const double distThresh )
 {
     double distToObs = rover->roverStatus().obstacle().distance;
     double bearToObs = rover->roverStatus().obstacle().bearing;
@@ -149,7 +108,7 @@ bool isLocationReachable( Rover* rover, const rapidjson::Document& roverConfig,
     isReachable |= distToObs > locDist - distThresh;
 
     // if obstacle is farther away in "x direction" than rover's width, it's reachable
-    isReachable |= xComponentOfDistToObs > roverConfig["roverMeasurements"]["width"].GetDouble() / 2;
+    isReachable |= xComponentOfDistToObs > roverConfig.roverMeasurements.width / 2;
 
     return isReachable;
 } // isLocationReachable()
@@ -161,7 +120,25 @@ bool isObstacleDetected( Rover* rover )
 } // isObstacleDetected()
 
 // Returns true if distance from obstacle is within user-configurable threshold
-bool isObstacleInThreshold( Rover* rover, const rapidjson::Document& roverConfig )
+bool isObstacleInThreshold( Rover* rover, const NavConfig& roverConfig )
 {
-    return rover->roverStatus().obstacle().distance <= roverConfig["navThresholds"]["obstacleDistanceThreshold"].GetDouble();
+    return rover->roverStatus().obstacle().distance <= roverConfig.navThresholds.obstacleDistanceThreshold;
 } // isObstacleInThreshold()
+
+// Returns the time in seconds that nav times its waits with. Only
+// differences between two calls mean anything.
+double navTime()
+{
+    if( navClock )
+    {
+        return navClock();
+    }
+    return chrono::duration<double>( chrono::steady_clock::now().time_since_epoch() ).count();
+} // navTime()
+
+// Replaces the clock navTime reads, so a simulator can run nav faster
+// than real time. nullptr goes back to the system clock.
+void setNavClock( double ( *clock )() )
+{
+    navClock = clock;
+} // setNavClock()
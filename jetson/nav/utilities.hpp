@@ -4,6 +4,7 @@
 #include <deque>
 #include "rover_msgs/Waypoint.hpp"
 #include "rover_msgs/Odometry.hpp"
+#include "localFrame.hpp"
 #include "rover.hpp"
 
 using namespace std;
@@ -12,32 +13,33 @@ using namespace rover_msgs;
 const int EARTH_RADIUS = 6371000; // meters
 const int EARTH_CIRCUM = 40075000; // meters
 const double PI = 3.141592654; // radians
-const double LAT_METER_IN_MINUTES = 0.0005389625; // minutes/meters
 
 double degreeToRadian( const double degree, const double minute = 0 );
 
 double radianToDegree( const double radian );
 
-Odometry addMinToDegrees( const Odometry & current, const double lat_minutes = 0, const double lon_minutes = 0 );
+double calcDistance( const LocalPoint& start, const LocalPoint& dest );
 
-double estimateNoneuclid( const Odometry& start, const Odometry& dest );
+double calcBearing( const LocalPoint& start, const LocalPoint& dest );
 
-Odometry createOdom ( const Odometry & current, const double bearing, const double distance, Rover * rover );
-
-double calcBearing( const Odometry& start, const Odometry& dest );
+LocalPoint createPoint( const LocalPoint& current, const double bearing, const double distance );
 
 double mod( const double degree, const int modulus );
 
 void throughZero( double& destinationBearing, const double currentBearing );
 
-void clear( deque<Waypoint>& aDeque );
+void clear( deque<LocalWaypoint>& aDeque );
 
-bool isTargetReachable( Rover* rover, const rapidjson::Document& roverConfig );
+bool isTargetReachable( Rover* rover, const NavConfig& roverConfig );
 
-bool isLocationReachable( Rover* rover, const rapidjson::Document& roverConfig, const double locDist, const double distThresh );
+bool isLocationReachable( Rover* rover, const NavConfig& roverConfig, const double locDist, const double distThresh );
 
 bool isObstacleDetected( Rover* rover );
 
-bool isObstacleInThreshold( Rover* rover, const rapidjson::Document& roverConfig );
+bool isObstacleInThreshold( Rover* rover, const NavConfig& roverConfig );
+
+double navTime();
+
+void setNavClock( double ( *clock )() );
 
 #endif // NAV_UTILITES
@@ -1,4 +1,5 @@
 #include "perception.hpp"
+#include "simd_kernels.hpp"
 
 static Mat HSV;
 static Mat DEPTH;
@@ -16,15 +17,11 @@ void onMouse(int event, int x, int y, int flags, void *userdata) {
 }
 
 //initializes detector object with pre-generated dictionary of tags 
-TagDetector::TagDetector(const rapidjson::Document &mRoverConfig) :  
-
-   //Populate Constants from Config File
-   BUFFER_ITERATIONS{mRoverConfig["ar_tag"]["buffer_iterations"].GetInt()},
-   MARKER_BORDER_BITS{mRoverConfig["alvar_params"]["marker_border_bits"].GetInt()},
-   DO_CORNER_REFINEMENT{!!mRoverConfig["alvar_params"]["do_corner_refinement"].GetInt()},
-   POLYGONAL_APPROX_ACCURACY_RATE{mRoverConfig["alvar_params"]["polygonal_approx_accuracy_rate"].GetDouble()},
-   MM_PER_M{mRoverConfig["mm_per_m"].GetInt()},
-   DEFAULT_TAG_VAL{mRoverConfig["ar_tag"]["default_tag_val"].GetInt()} {
+TagDetector::TagDetector(const rapidjson::Document &mRoverConfig) {
+    trackedTags = 0;
+    framesSinceFullScan = 0;
+    framesSinceFullResScan = 0;
+    lastTagSize = 0;
 
     cv::FileStorage fsr("jetson/percep/alvar_dict.yml", cv::FileStorage::READ);
     if (!fsr.isOpened()) {  //throw error if dictionary file does not exist
@@ -41,8 +38,32 @@ TagDetector::TagDetector(const rapidjson::Document &mRoverConfig) :
     fsr.release();
     alvarDict = new cv::aruco::Dictionary(bits, mSize, mCBits);
 
-    // initialize other special parameters that we need to properly detect the URC (Alvar) tags
     alvarParams = new cv::aruco::DetectorParameters();
+    configure(mRoverConfig);
+}
+
+void TagDetector::configure(const rapidjson::Document &mRoverConfig) {
+    //Populate Constants from Config File
+    BUFFER_ITERATIONS = mRoverConfig["ar_tag"]["buffer_iterations"].GetInt();
+    MARKER_BORDER_BITS = mRoverConfig["alvar_params"]["marker_border_bits"].GetInt();
+    DO_CORNER_REFINEMENT = !!mRoverConfig["alvar_params"]["do_corner_refinement"].GetInt();
+    POLYGONAL_APPROX_ACCURACY_RATE = mRoverConfig["alvar_params"]["polygonal_approx_accuracy_rate"].GetDouble();
+    MM_PER_M = mRoverConfig["mm_per_m"].GetInt();
+    DEFAULT_TAG_VAL = mRoverConfig["ar_tag"]["default_tag_val"].GetInt();
+    TRACKING_ENABLED = !!mRoverConfig["ar_tag"]["tracking"]["enabled"].GetInt();
+    FULL_SCAN_INTERVAL = mRoverConfig["ar_tag"]["tracking"]["full_scan_interval"].GetInt();
+    ROI_MARGIN = mRoverConfig["ar_tag"]["tracking"]["roi_margin"].GetDouble();
+    MIN_ROI_MARGIN = mRoverConfig["ar_tag"]["tracking"]["min_roi_margin_px"].GetInt();
+    MIN_PYRAMID_TAG_SIZE = mRoverConfig["alvar_params"]["min_pyramid_tag_px"].GetInt();
+    FULL_RES_SCAN_INTERVAL = mRoverConfig["alvar_params"]["full_res_scan_interval"].GetInt();
+
+    PYRAMID_SCALES.clear();
+    for (auto &scale : mRoverConfig["alvar_params"]["pyramid_scales"].GetArray()) {
+        if (scale.GetInt() > 1) PYRAMID_SCALES.push_back(scale.GetInt());
+    }
+    sort(PYRAMID_SCALES.rbegin(), PYRAMID_SCALES.rend());
+
+    // initialize other special parameters that we need to properly detect the URC (Alvar) tags
     alvarParams->markerBorderBits = MARKER_BORDER_BITS;
     alvarParams->doCornerRefinement = DO_CORNER_REFINEMENT;
     alvarParams->polygonalApproxAccuracyRate = POLYGONAL_APPROX_ACCURACY_RATE;
@@ -63,17 +84,28 @@ Point2f TagDetector::getAverageTagCoordinateFromCorners(const vector<Point2f> &c
 }
 
 pair<Tag, Tag> TagDetector::findARTags(Mat &src, Mat &depth_src, Mat &rgb) {  //detects AR tags in source Mat and outputs Tag objects for use in LCM
+    LatencyProbe probe(Stage::ARDetection);
+
     // RETURN:
     // pair of target objects- each object has an x and y for the center,
     // and the tag ID number return them such that the "leftmost" (x
     // coordinate) tag is at index 0
-    cvtColor(src, rgb, COLOR_RGBA2RGB);
-    // clear ids and corners vectors for each detection
-    ids.clear();
-    corners.clear();
-
+    // The detector thresholds luminance only, so feed it a single channel
+    // image made in one SIMD pass instead of an RGB copy it converts again
+    if (src.channels() == 4 && src.depth() == CV_8U && src.isContinuous()) {
+        gray.create(src.rows, src.cols, CV_8UC1);
+        bgraToGray(src.ptr<uint8_t>(), gray.ptr<uint8_t>(), src.total());
+    }
+    else cvtColor(src, gray, src.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
     // Find tags
-    cv::aruco::detectMarkers(rgb, alvarDict, corners, ids, alvarParams);
+    detect(gray);
+
+    // Only recording and debug drawing need a color image
+    #if AR_RECORD || PERCEPTION_DEBUG
+    if (src.channels() == 4) cvtColor(src, rgb, COLOR_RGBA2RGB);
+    else src.copyTo(rgb);
+    #endif
+
     #if AR_RECORD
     cv::aruco::drawDetectedMarkers(rgb, corners, ids);
     #endif
@@ -135,6 +167,132 @@ pair<Tag, Tag> TagDetector::findARTags(Mat &src, Mat &depth_src, Mat &rgb) {  //
     return discoveredTags;
 }
 
+void TagDetector::detect(const Mat &image) {
+    ++framesSinceFullResScan;
+
+    //Tags move a little between frames, so look where they were first
+    if (TRACKING_ENABLED && !trackedRois.empty() && framesSinceFullScan < FULL_SCAN_INTERVAL) {
+        ++trackingStats.roiScans;
+        ++framesSinceFullScan;
+        if (detectInRois(image)) {
+            ++trackingStats.roiHits;
+            updateRois(image.size());
+            return;
+        }
+        ++trackingStats.roiMisses;
+
+        //A tag moved out of its roi, look for the tracked tags again on a downscaled image
+        if (detectPyramid(image)) {
+            ++trackingStats.pyramidScans;
+            return;
+        }
+    }
+    //Scans of the whole image try a downscaled copy first while the tracked tags
+    //are big. New far tags can be too small to show up there, so every so often
+    //the whole image is searched at full resolution regardless.
+    else if (framesSinceFullResScan < FULL_RES_SCAN_INTERVAL && detectPyramid(image)) {
+        ++trackingStats.pyramidScans;
+        framesSinceFullScan = 0;
+        return;
+    }
+
+    ++trackingStats.fullScans;
+    framesSinceFullScan = 0;
+    framesSinceFullResScan = 0;
+    detectFull(image);
+    updateRois(image.size());
+}
+
+bool TagDetector::detectPyramid(const Mat &image) {
+    //Tags as big as the ones being tracked are found just as well on a downscaled
+    //image, then their corners are refined in full resolution patches around them
+    int scale = pyramidScale();
+    if (scale == 1) return false;
+    size_t tracked = trackedTags;
+
+    resize(image, pyramidImage, Size(), 1.0 / scale, 1.0 / scale, INTER_AREA);
+    ids.clear();
+    corners.clear();
+    cv::aruco::detectMarkers(pyramidImage, alvarDict, corners, ids, alvarParams);
+    if (ids.empty()) return false;
+
+    for (auto &tagCorners : corners) {
+        for (Point2f &corner : tagCorners) corner *= (float)scale;
+    }
+    updateRois(image.size());
+    if (!detectInRois(image)) return false;
+
+    //A tracked tag that didn't show up may have shrunk past the scale, so it
+    //takes a full resolution scan to tell whether it is still there
+    if (ids.size() < tracked) return false;
+    updateRois(image.size());
+    return true;
+}
+
+void TagDetector::detectFull(const Mat &image) {
+    // clear ids and corners vectors for each detection
+    ids.clear();
+    corners.clear();
+    cv::aruco::detectMarkers(image, alvarDict, corners, ids, alvarParams);
+}
+
+bool TagDetector::detectInRois(const Mat &image) {
+    ids.clear();
+    corners.clear();
+    for (const Rect &roi : trackedRois) {
+        //The roi is a view into image, so nothing is copied
+        roiIds.clear();
+        roiCorners.clear();
+        cv::aruco::detectMarkers(image(roi), alvarDict, roiCorners, roiIds, alvarParams);
+        for (size_t i = 0; i < roiIds.size(); ++i) {
+            for (Point2f &corner : roiCorners[i]) {
+                corner += Point2f(roi.x, roi.y);
+            }
+            ids.push_back(roiIds[i]);
+            corners.push_back(roiCorners[i]);
+        }
+    }
+    //Merged rois can each hold more than one tag, so compare counts rather than rois
+    return ids.size() >= trackedTags;
+}
+
+void TagDetector::updateRois(const Size &imageSize) {
+    trackedRois.clear();
+    trackedTags = ids.size();
+    lastTagSize = 0;
+    Rect bounds(Point(0, 0), imageSize);
+    for (const auto &tagCorners : corners) {
+        //Grow each tag's box by how far it could move before the next frame
+        Rect box = boundingRect(tagCorners);
+        int size = min(box.width, box.height);
+        lastTagSize = lastTagSize ? min(lastTagSize, size) : size;
+        int margin = max(MIN_ROI_MARGIN, (int)(ROI_MARGIN * max(box.width, box.height)));
+        Rect roi = Rect(box.x - margin, box.y - margin, box.width + 2 * margin, box.height + 2 * margin) & bounds;
+
+        //Tags on the same post overlap, search them together so neither is cut off
+        for (size_t i = 0; i < trackedRois.size(); ) {
+            if ((roi & trackedRois[i]).area() > 0) {
+                roi |= trackedRois[i];
+                trackedRois.erase(trackedRois.begin() + i);
+                i = 0;
+            }
+            else ++i;
+        }
+        trackedRois.push_back(roi);
+    }
+}
+
+int TagDetector::pyramidScale() const {
+    for (int scale : PYRAMID_SCALES) {
+        if (lastTagSize / scale >= MIN_PYRAMID_TAG_SIZE) return scale;
+    }
+    return 1;
+}
+
+const TrackingStats &TagDetector::stats() const {
+    return trackingStats;
+}
+
 double TagDetector::getAngle(float xPixel, float wPixel){
     double fieldofView = 110 * PI/180;
     return atan((xPixel - wPixel/2)/(wPixel/2)* tan(fieldofView/2))* 180.0 /PI;
@@ -12,13 +12,49 @@ struct Tag {
     int id;
 };
 
+//How often tracking found the tags in their regions of interest
+struct TrackingStats {
+    long roiScans = 0;  //frames searched only around the last tags
+    long roiHits = 0;   //roi scans that found every tracked tag
+    long roiMisses = 0;    //roi scans that lost a tag and fell back to a whole image scan
+    long pyramidScans = 0; //whole image scans that found the tags on a downscaled image
+    long fullScans = 0;    //whole image scans at full resolution, including fallbacks
+};
+
 class TagDetector {
    private:
     Ptr<cv::aruco::Dictionary> alvarDict;
     Ptr<cv::aruco::DetectorParameters> alvarParams;
     std::vector<int> ids;
     std::vector<std::vector<cv::Point2f> > corners;
-    cv::Mat rgb;
+    cv::Mat gray; //luminance the tags are detected in, reused every frame
+
+    //Tracking state, regions around the tags found last frame
+    std::vector<cv::Rect> trackedRois;
+    size_t trackedTags;
+    std::vector<int> roiIds;
+    std::vector<std::vector<cv::Point2f> > roiCorners;
+    int framesSinceFullScan;
+    int framesSinceFullResScan;
+    TrackingStats trackingStats;
+
+    //Smallest side of the tags found last frame in pixels, 0 if none were found
+    int lastTagSize;
+    cv::Mat pyramidImage;
+
+    //Fills ids and corners, searching only around the last tags when tracking
+    void detect(const Mat &image);
+    //Searches the whole image at full resolution
+    void detectFull(const Mat &image);
+    //Searches the whole image downscaled to fit the last tags, returns false
+    //if no tags were found or they couldn't be refined at full resolution
+    bool detectPyramid(const Mat &image);
+    //Searches trackedRois, returns false if any tracked tag wasn't found again
+    bool detectInRois(const Mat &image);
+    //Sets trackedRois from the tags just detected
+    void updateRois(const Size &imageSize);
+    //Downscale factor the last tags are expected to still be found at, 1 for full resolution
+    int pyramidScale() const;
     
    public:
    //Constants:
@@ -28,16 +64,28 @@ class TagDetector {
    double POLYGONAL_APPROX_ACCURACY_RATE;
    int MM_PER_M;
    int DEFAULT_TAG_VAL;
+   bool TRACKING_ENABLED;
+   int FULL_SCAN_INTERVAL;
+   double ROI_MARGIN;
+   int MIN_ROI_MARGIN;
+   std::vector<int> PYRAMID_SCALES; //largest first
+   int MIN_PYRAMID_TAG_SIZE;
+   int FULL_RES_SCAN_INTERVAL; //frames between whole image scans that skip the pyramid
 
     //constructor loads alvar dictionary data from file that defines tag bit configurations
     TagDetector(const rapidjson::Document &mRoverConfig);    
+    //reads the constants, call between frames to pick up a reloaded config
+    void configure(const rapidjson::Document &mRoverConfig);
     //takes detected AR tag and finds center coordinate for use with ZED                                                                 
     Point2f getAverageTagCoordinateFromCorners(const vector<Point2f> &corners);
-    //detects AR tags in a given Mat     
+    //detects AR tags in a given Mat
+    //rgb is only filled in when AR_RECORD or PERCEPTION_DEBUG needs it
     pair<Tag, Tag> findARTags(Mat &src, Mat &depth_src, Mat &rgb);    
     //finds the angle from center given pixel coordinates              
     double getAngle(float xPixel, float wPixel);     
     //if AR tag found, updates distance, bearing, and id                              
     void updateDetectedTagInfo(rover_msgs::Target *arTags, pair<Tag, Tag> &tagPair, Mat &depth_img, Mat &src); 
+    //counts of roi and full frame searches since the detector was created
+    const TrackingStats &stats() const;
     
 };
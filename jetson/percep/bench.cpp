@@ -0,0 +1,338 @@
+#include "perception.hpp"
+#include "percep_config.hpp"
+#include "depth_obstacle.hpp"
+#include "pipeline.hpp"
+#include "rover_msgs/Target.hpp"
+#include "rover_msgs/TargetList.hpp"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/prettywriter.h"
+#include <sys/resource.h>
+#include <stdexcept>
+
+using namespace cv;
+using namespace std;
+
+/* --- Perception Replay Benchmark --- */
+//Replays a recorded dataset through the perception stages as fast as possible
+//and reports throughput, stage latencies and peak memory as JSON. Given a
+//baseline from an earlier run it exits non-zero if anything got slower, and
+//it always does if frame buffers still allocate once the pool is warm.
+
+static void usage(const char *prog) {
+    cerr << "Usage: " << prog << " <dataset folder> [--iterations N] [--stages ar,obstacle]"
+         << " [--baseline file.json] [--tolerance 0.1] [--output file.json]\n";
+}
+
+//Peak resident set size of this process in kilobytes
+static long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+//Parses a whole decimal int no smaller than min
+static bool parseInt(const string &text, int &value, int min) {
+    size_t used = 0;
+    try {
+        value = stoi(text, &used);
+    }
+    catch (const logic_error &) {
+        return false;
+    }
+    return used == text.size() && value >= min;
+}
+
+//Parses a whole number no smaller than min
+static bool parseDouble(const string &text, double &value, double min) {
+    size_t used = 0;
+    try {
+        value = stod(text, &used);
+    }
+    catch (const logic_error &) {
+        return false;
+    }
+    return used == text.size() && value >= min;
+}
+
+//Parses a comma separated list of stage names, each of which must be ar or obstacle
+static bool parseStages(const string &text, bool &runAR, bool &runObstacle) {
+    runAR = false;
+    runObstacle = false;
+    size_t begin = 0;
+    while (true) {
+        size_t end = text.find(',', begin);
+        string stage = text.substr(begin, end == string::npos ? string::npos : end - begin);
+        if (stage == "ar") runAR = true;
+        else if (stage == "obstacle") runObstacle = true;
+        else return false;
+        if (end == string::npos) return true;
+        begin = end + 1;
+    }
+}
+
+//Compares results against a stored run, printing every regression found
+//Returns true if nothing regressed by more than tolerance
+static bool compareBaseline(const rapidjson::Document &results, const rapidjson::Document &baseline, double tolerance) {
+    bool passed = true;
+
+    double fps = results["throughput_fps"].GetDouble();
+    double baseFps = baseline["throughput_fps"].GetDouble();
+    if (fps < baseFps * (1 - tolerance)) {
+        cerr << "Regression: throughput " << fps << " fps, baseline " << baseFps << " fps\n";
+        passed = false;
+    }
+
+    double rss = results["peak_rss_kb"].GetDouble();
+    double baseRss = baseline["peak_rss_kb"].GetDouble();
+    if (rss > baseRss * (1 + tolerance)) {
+        cerr << "Regression: peak RSS " << rss << " kB, baseline " << baseRss << " kB\n";
+        passed = false;
+    }
+
+    //Only stages both runs timed can be compared
+    const rapidjson::Value &stages = results["stages"];
+    const rapidjson::Value &baseStages = baseline["stages"];
+    for (auto stage = stages.MemberBegin(); stage != stages.MemberEnd(); ++stage) {
+        auto baseStage = baseStages.FindMember(stage->name);
+        if (baseStage == baseStages.MemberEnd()) continue;
+
+        double p95 = stage->value["p95_ms"].GetDouble();
+        double baseP95 = baseStage->value["p95_ms"].GetDouble();
+        if (p95 > baseP95 * (1 + tolerance)) {
+            cerr << "Regression: " << stage->name.GetString() << " p95 " << p95 << " ms, baseline " << baseP95 << " ms\n";
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+int main(int argc, char **argv) {
+    /* --- Arguments --- */
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    string dataset = argv[1];
+    int iterations = 1;
+    bool runAR = AR_DETECTION;
+    bool runObstacle = OBSTACLE_DETECTION;
+    string baselinePath;
+    string outputPath;
+    double tolerance = 0.1;
+
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        if (arg == "--iterations") ok = parseInt(value, iterations, 1);
+        else if (arg == "--stages") ok = parseStages(value, runAR, runObstacle);
+        else if (arg == "--baseline") baselinePath = value;
+        else if (arg == "--tolerance") ok = parseDouble(value, tolerance, 0);
+        else if (arg == "--output") outputPath = value;
+        else ok = false;
+        if (!ok) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if ((runAR && !AR_DETECTION) || (runObstacle && !OBSTACLE_DETECTION)) {
+        cerr << "Requested stage was not built, check the ar_detection and obs_detection options\n";
+        return 2;
+    }
+
+    /* --- Initializations --- */
+    rapidjson::Document mRoverConfig;
+    //Same config the perception binary runs with
+    string configError;
+    if (!loadConfig(configPath(), mRoverConfig, configError)) {
+        cerr << "Error: " << configError << endl;
+        return 2;
+    }
+
+    Camera cam(mRoverConfig, dataset);
+    TagDetector detector(mRoverConfig);
+
+    #if AR_DETECTION
+    rover_msgs::TargetList arTagsMessage;
+    rover_msgs::Target* arTags = arTagsMessage.targetList;
+    arTags[0].distance = detector.DEFAULT_TAG_VAL;
+    arTags[1].distance = detector.DEFAULT_TAG_VAL;
+    pair<Tag, Tag> tagPair;
+    Mat rgb;
+    #endif
+
+    #if OBSTACLE_DETECTION
+    PCL pointcloud(mRoverConfig);
+
+    //Times whichever obstacle mode the config picks, like the perception binary
+    bool depthObstacles = mRoverConfig["depth_obstacle"]["enabled"].GetInt() != 0;
+    DepthObstacleDetector depthDetector(mRoverConfig);
+    #endif
+
+    //Grabs are copied into pooled frames the way the capture stage does, so
+    //the replay also checks the copies stop allocating once the pool is warm
+    BufferPool<Frame> framePool;
+    SteadyStateCheck steadyState(mRoverConfig["pipeline"]["pool_warmup_frames"].GetInt());
+
+    //Start the stage histograms from zero so only the replay is counted
+    rover_msgs::PerceptionLatency latency;
+    telemetry().snapshotAndReset(latency);
+
+    /* --- Replay --- */
+    long frames = 0;
+    auto start = chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        cam.rewind();
+        while (true) {
+            auto grabTime = chrono::steady_clock::now();
+            if (!cam.grab()) break;
+
+            //Offline images are read from disk when asked for, so that counts as grabbing
+            shared_ptr<Frame> frame = framePool.acquire();
+            steadyState.before(*frame);
+
+            #if AR_DETECTION
+            if (runAR) {
+                cam.image().copyTo(frame->rgb);
+                cam.depth().copyTo(frame->depth);
+            }
+            #endif
+
+            #if OBSTACLE_DETECTION
+            if (runObstacle && depthObstacles) cam.depth().copyTo(frame->depth);
+            else if (runObstacle) {
+                size_t cloudPoints = (size_t)pointcloud.PT_CLOUD_WIDTH * pointcloud.PT_CLOUD_HEIGHT;
+                frame->cloud.reserve(cloudPoints);
+                cam.getDataCloud(frame->cloud, pointcloud.PT_CLOUD_WIDTH, pointcloud.PT_CLOUD_HEIGHT);
+            }
+            #endif
+
+            if (!steadyState.after(frames, *frame, framePool.allocations())) {
+                cerr << "Frame " << frames << " allocated in steady state\n";
+            }
+            telemetry()[Stage::Grab].record(chrono::steady_clock::now() - grabTime);
+
+            #if AR_DETECTION
+            if (runAR) {
+                arTags[0].distance = detector.DEFAULT_TAG_VAL;
+                arTags[1].distance = detector.DEFAULT_TAG_VAL;
+                tagPair = detector.findARTags(frame->rgb, frame->depth, rgb);
+                detector.updateDetectedTagInfo(arTags, tagPair, frame->depth, frame->rgb);
+            }
+            #endif
+
+            #if OBSTACLE_DETECTION
+            if (runObstacle && depthObstacles) depthDetector.detect(frame->depth);
+            else if (runObstacle) {
+                pointcloud.input = &frame->cloud;
+                pointcloud.pcl_obstacle_detection();
+            }
+            #endif
+
+            ++frames;
+        }
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (!frames) {
+        cerr << "No frames found in " << dataset << "\n";
+        return 2;
+    }
+
+    /* --- Results --- */
+    telemetry().snapshotAndReset(latency);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("dataset");
+    writer.String(dataset.c_str());
+    writer.Key("iterations");
+    writer.Int(iterations);
+    writer.Key("frames");
+    writer.Int64(frames);
+    writer.Key("elapsed_s");
+    writer.Double(elapsed);
+    writer.Key("throughput_fps");
+    writer.Double(frames / elapsed);
+    writer.Key("peak_rss_kb");
+    writer.Int64(peakRssKb());
+    writer.Key("steady_state_allocations");
+    writer.Int64(steadyState.allocations());
+    writer.Key("stages");
+    writer.StartObject();
+    for (auto &stage : latency.stages) {
+        if (!stage.count) continue;
+        writer.Key(stage.name.c_str());
+        writer.StartObject();
+        writer.Key("count");
+        writer.Int64(stage.count);
+        writer.Key("p50_ms");
+        writer.Double(stage.p50_ms);
+        writer.Key("p95_ms");
+        writer.Double(stage.p95_ms);
+        writer.Key("p99_ms");
+        writer.Double(stage.p99_ms);
+        writer.Key("max_ms");
+        writer.Double(stage.max_ms);
+        writer.EndObject();
+    }
+    writer.EndObject();
+
+    #if AR_DETECTION
+    if (runAR) {
+        const TrackingStats &tracking = detector.stats();
+        writer.Key("ar_tracking");
+        writer.StartObject();
+        writer.Key("roi_scans");
+        writer.Int64(tracking.roiScans);
+        writer.Key("roi_hits");
+        writer.Int64(tracking.roiHits);
+        writer.Key("roi_misses");
+        writer.Int64(tracking.roiMisses);
+        writer.Key("pyramid_scans");
+        writer.Int64(tracking.pyramidScans);
+        writer.Key("full_scans");
+        writer.Int64(tracking.fullScans);
+        writer.EndObject();
+    }
+    #endif
+    writer.EndObject();
+
+    cout << buffer.GetString() << endl;
+    if (!outputPath.empty()) {
+        ofstream output(outputPath);
+        output << buffer.GetString() << endl;
+    }
+
+    //Allocating in steady state fails the run whether or not there is a baseline
+    if (steadyState.allocations()) {
+        cerr << "Regression: " << steadyState.allocations() << " frames allocated after warmup\n";
+        return 1;
+    }
+
+    /* --- Baseline Comparison --- */
+    if (baselinePath.empty()) return 0;
+
+    ifstream baselineFile(baselinePath);
+    if (!baselineFile) {
+        cerr << "Could not open baseline " << baselinePath << "\n";
+        return 2;
+    }
+    string baselineText((istreambuf_iterator<char>(baselineFile)), istreambuf_iterator<char>());
+    rapidjson::Document baseline;
+    baseline.Parse(baselineText.c_str());
+    if (baseline.HasParseError() || !baseline.IsObject()) {
+        cerr << "Could not parse baseline " << baselinePath << "\n";
+        return 2;
+    }
+
+    rapidjson::Document results;
+    results.Parse(buffer.GetString());
+    return compareBaseline(results, baseline, tolerance) ? 0 : 1;
+}
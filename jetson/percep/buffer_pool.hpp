@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/* --- Buffer Pool --- */
+/**
+\brief Hands out reusable buffers so frames don't hit the allocator
+Buffers are kept for the life of the pool. acquire returns a buffer nobody
+else holds, or allocates a new one if they are all in use, so after a few
+frames the pool has grown to the number of frames in flight and stops
+allocating. allocations counts every buffer the pool has ever created,
+so steady state can be checked by watching it stop increasing. A pool made
+with a maximum never grows past it, and acquire returns nullptr instead.
+acquire must only be called from one thread, buffers may be released on any.
+*/
+template <typename T>
+class BufferPool {
+    public:
+        //maxBuffers of 0 lets the pool grow as far as it is asked to
+        BufferPool(size_t maxBuffers = 0) : maxBuffers_(maxBuffers), allocations_(0) {}
+
+        //Returns a buffer that is not held anywhere else, or nullptr if they
+        //are all in use and the pool is at its maximum
+        //Its contents are whatever the last user left in it
+        std::shared_ptr<T> acquire() {
+            for (auto &buffer : buffers_) {
+                //Only the pool holds it, and only this thread can hand out new references
+                if (buffer.use_count() == 1) {
+                    //Make the last user's writes visible before reusing the buffer
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    return buffer;
+                }
+            }
+            if (maxBuffers_ && buffers_.size() >= maxBuffers_) return nullptr;
+            buffers_.push_back(std::make_shared<T>());
+            ++allocations_;
+            return buffers_.back();
+        }
+
+        //Number of buffers allocated since the pool was created
+        long allocations() const {
+            return allocations_.load();
+        }
+
+    private:
+        std::vector<std::shared_ptr<T>> buffers_;
+        size_t maxBuffers_;
+        std::atomic<long> allocations_;
+};
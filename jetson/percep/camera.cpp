@@ -1,8 +1,28 @@
 #include "camera.hpp"
 #include "perception.hpp"
+#include "recorder.hpp"
 
 #if OBSTACLE_DETECTION
     #include <pcl/common/common_headers.h>
+    #include "simd_kernels.hpp"
+
+/* --- Crop In Place --- */
+//Same crop as cropAndPack for clouds that are already in PCL format
+static void cropInPlace(const PassThroughBounds &bounds, pcl::PointCloud<pcl::PointXYZRGB> &cloud) {
+    pcl::PointXYZRGB * __restrict pts = cloud.points.data();
+    size_t numPoints = cloud.points.size();
+    size_t kept = 0;
+
+    for (size_t i = 0; i < numPoints; ++i) {
+        pts[kept] = pts[i];
+        kept += bounds.keep(pts[i].x, pts[i].y, pts[i].z);
+    }
+
+    cloud.points.resize(kept);
+    cloud.width = kept;
+    cloud.height = 1;
+    cloud.is_dense = true;
+}
 #endif
 
 #if ZED_SDK_PRESENT
@@ -20,7 +40,7 @@
 //but can use sample images for testing
 class Camera::Impl {
 public:
-    Impl(const rapidjson::Document &config);
+    Impl(const rapidjson::Document &config, const std::string &folder);
     ~Impl();
 	bool grab();
 
@@ -31,10 +51,15 @@ public:
     int THRESHOLD_CONFIDENCE;
 
     #if OBSTACLE_DETECTION
-    void dataCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud);
+    void dataCloud(CompactCloud &cloud, int width, int height);
+    bool recordCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud);
     #endif
   
 private:
+    #if OBSTACLE_DETECTION
+    PassThroughBounds bounds_;
+    #endif
+
 	sl::RuntimeParameters runtime_params_;
 	sl::Resolution image_size_;
 	sl::Camera zed_;
@@ -42,11 +67,23 @@ private:
 	sl::Mat image_zed_;
 	sl::Mat depth_zed_;
 
+    #if OBSTACLE_DETECTION
+    //Allocated on first use and kept so retrieving the cloud doesn't allocate
+    sl::Mat cloud_zed_;
+
+    //Whether cloud_zed_ holds this grab's cloud
+    bool cloudGrabbed_ = false;
+    #endif
+
 	cv::Mat image_;
 	cv::Mat depth_;
 };
 
-Camera::Impl::Impl(const rapidjson::Document &config) : THRESHOLD_CONFIDENCE(config["camera"]["threshold_confidence"].GetDouble()) {
+Camera::Impl::Impl(const rapidjson::Document &config, const std::string &folder) : THRESHOLD_CONFIDENCE(config["camera"]["threshold_confidence"].GetDouble())
+    #if OBSTACLE_DETECTION
+    , bounds_(config)
+    #endif
+{
 	sl::InitParameters init_params;
 	init_params.camera_resolution = sl::RESOLUTION::HD720; // default: 720p
 	init_params.depth_mode = sl::DEPTH_MODE::PERFORMANCE;
@@ -82,6 +119,9 @@ Camera::Impl::Impl(const rapidjson::Document &config) : THRESHOLD_CONFIDENCE(con
 }
 
 bool Camera::Impl::grab() {
+    #if OBSTACLE_DETECTION
+    cloudGrabbed_ = false;
+    #endif
     return this->zed_.grab() == sl::ERROR_CODE::SUCCESS;
 }
 
@@ -96,44 +136,56 @@ cv::Mat Camera::Impl::depth() {
 	return this->depth_;
 }
 
-//This function convert a RGBA color packed into a packed RGBA PCL compatible format
-inline float convertColor(float colorIn) {
-    uint32_t color_uint = *(uint32_t *) & colorIn;
-    unsigned char *color_uchar = (unsigned char *) &color_uint;
-    color_uint = ((uint32_t) color_uchar[0] << 16 | (uint32_t) color_uchar[1] << 8 | (uint32_t) color_uchar[2]);
-    return *reinterpret_cast<float *> (&color_uint);
-}
-
 Camera::Impl::~Impl() {
+    #if OBSTACLE_DETECTION
+    this->cloud_zed_.free(sl::MEM::CPU);
+    #endif
     this->depth_zed_.free(sl::MEM::CPU);
     this->image_zed_.free(sl::MEM::CPU);
 	this->zed_.close();
 }
 
 #if OBSTACLE_DETECTION
-void Camera::Impl::dataCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr & p_pcl_point_cloud) {
-    //Might need an overloaded assignment operator
-  
+void Camera::Impl::dataCloud(CompactCloud &cloud, int width, int height) {
     //Grab ZED Depth Image
-    sl::Resolution cloud_res(p_pcl_point_cloud->width, p_pcl_point_cloud->height);
-    sl::Mat data_cloud;
-    this->zed_.retrieveMeasure(data_cloud, sl::MEASURE::XYZRGBA, sl::MEM::CPU, cloud_res);
+    sl::Resolution cloud_res(width, height);
+    if (this->cloud_zed_.getWidth() != cloud_res.width || this->cloud_zed_.getHeight() != cloud_res.height) {
+        this->cloud_zed_.alloc(cloud_res, sl::MAT_TYPE::F32_C4, sl::MEM::CPU);
+    }
+    this->zed_.retrieveMeasure(this->cloud_zed_, sl::MEASURE::XYZRGBA, sl::MEM::CPU, cloud_res);
   
-    //Populate Point Cloud
-    float *p_data_cloud = data_cloud.getPtr<float>();
-    int index = 0;
-    for (auto &it : p_pcl_point_cloud->points) {
-        float X = p_data_cloud[index];
-        if (!isValidMeasure(X)) // Checking if it's a valid point
-            it.x = it.y = it.z = it.rgb = 0;
+    //Populate Point Cloud, cropping to the pass through bounds as we go
+    cropAndPack(this->cloud_zed_.getPtr<float>(), cloud_res.area(), bounds_, cloud);
+    cloudGrabbed_ = true;
+}
+
+//Copies this grab's cloud as the ZED gave it, uncropped and with color, with
+//invalid measures at the origin the way recorded .pcd files have always had them
+bool Camera::Impl::recordCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud) {
+    if (!cloudGrabbed_) return false;
+
+    const float *xyzrgba = this->cloud_zed_.getPtr<float>();
+    cloud.width = this->cloud_zed_.getWidth();
+    cloud.height = this->cloud_zed_.getHeight();
+    cloud.is_dense = true;
+    cloud.points.resize((size_t)cloud.width * cloud.height);
+    for (auto &pt : cloud.points) {
+        if (!std::isfinite(xyzrgba[0])) {
+            pt.x = pt.y = pt.z = 0;
+            pt.rgba = 0;
+        }
         else {
-            it.x = X;
-            it.y = p_data_cloud[index + 1];
-            it.z = p_data_cloud[index + 2];
-            it.rgb = convertColor(p_data_cloud[index + 3]); // Convert a 32bits float into a pcl .rgb format
+            pt.x = xyzrgba[0];
+            pt.y = xyzrgba[1];
+            pt.z = xyzrgba[2];
+            //The ZED packs color as r, g, b, a bytes in the fourth float
+            uint8_t color[4];
+            memcpy(color, xyzrgba + 3, sizeof(color));
+            pt.rgba = (uint32_t)color[0] << 16 | (uint32_t)color[1] << 8 | color[2];
         }
-    index += 4;
-  }
+        xyzrgba += 4;
+    }
+    return true;
 }
 #endif
 
@@ -144,167 +196,228 @@ void Camera::Impl::dataCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr & p_pcl_poin
 #include <errno.h>
 #include <vector>
 #include <unordered_set>
+#include "loader.hpp"
 class Camera::Impl {
 public:
-    Impl(const rapidjson::Document &config);
+    Impl(const rapidjson::Document &config, const std::string &folder);
     ~Impl();
     bool grab();
+    void rewind();
 
     #if AR_DETECTION
     cv::Mat image();
+    #endif
+
+    #if AR_DETECTION || OBSTACLE_DETECTION
     cv::Mat depth();
     #endif
 
     #if OBSTACLE_DETECTION
-    void dataCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud);
-    void pcl_write(const cv::String &filename, pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud);
+    void dataCloud(CompactCloud &cloud, int width, int height);
+    bool recordCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud);
+    #endif
+
+private:
+    //Decode frame idx from disk, called from the loader threads
+    void decode(size_t idx, OfflineFrame &frame);
+
+    //Lists the files in dir with one of tails, sorted
+    static std::vector<std::string> listFiles(DIR *dir, const std::unordered_set<std::string> &tails);
 
+    #if AR_DETECTION
+    cv::Mat loadImage(size_t idx);
     #endif
 
-    void disk_record_init();
-    void write_curr_frame_to_disk(cv::Mat rgb, cv::Mat depth, int counter);
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    cv::Mat loadDepth(size_t idx);
+    #endif
 
-private:
+    #if OBSTACLE_DETECTION
+    void loadCloud(size_t idx, OfflineFrame &frame);
+
+    PassThroughBounds bounds_;
+
+    //Whether dataCloud was called since the last grab
+    bool cloudGrabbed_ = false;
+    #endif
+
+    //Depth is read for AR detection and depth obstacle detection, clouds for
+    //point cloud obstacle detection, so depth obstacle datasets need no clouds
+    bool read_depth;
+    bool read_cloud;
+
+    //Frames are named after the rgb images, or the depth files without AR detection
     std::vector<std::string> img_names;
     std::vector<std::string> pcd_names;
 
-    size_t idx_curr_img;
-    size_t idx_curr_pcd_img;
+    size_t idx_curr_frame;
+    size_t num_frames;
+
+    //Frames are decoded ahead of grab on the loader's threads
+    std::unique_ptr<FrameLoader> loader_;
+    const OfflineFrame *frame_;
 
     std::string path;
     std::string rgb_path;
-    DIR * rgb_dir;
+    DIR * rgb_dir = NULL;
     std::string depth_path;
-    DIR * depth_dir;
+    DIR * depth_dir = NULL;
     std::string pcd_path;
-    DIR * pcd_dir;
+    DIR * pcd_dir = NULL;
 };
 
 Camera::Impl::~Impl() {
-    closedir(rgb_dir);
-    closedir(depth_dir);
-    closedir(pcd_dir);
+    //Stop the loader threads before the paths they read from go away
+    loader_.reset();
+    if (rgb_dir) closedir(rgb_dir);
+    if (depth_dir) closedir(depth_dir);
+    if (pcd_dir) closedir(pcd_dir);
 }
 
-Camera::Impl::Impl(const rapidjson::Document &config) {
+Camera::Impl::Impl(const rapidjson::Document &config, const std::string &folder) :
+    #if OBSTACLE_DETECTION
+    bounds_(config),
+    read_depth(AR_DETECTION || config["depth_obstacle"]["enabled"].GetInt() != 0),
+    read_cloud(config["depth_obstacle"]["enabled"].GetInt() == 0),
+    #else
+    read_depth(AR_DETECTION), read_cloud(false),
+    #endif
+    idx_curr_frame(0), num_frames(0), frame_(nullptr)
+{
   
-    std::cout<<"Please input the folder path (there should be a rgb and depth existing in this folder): ";
-    std::cin>>path;
+    path = folder;
+    if (path.empty()) {
+        std::cout<<"Please input the folder path (there should be a rgb and depth existing in this folder): ";
+        std::cin>>path;
+    }
     #if AR_DETECTION
     rgb_path = path + "/rgb";
-    depth_path = path + "/depth";
     rgb_dir = opendir(rgb_path.c_str() );
-    depth_dir = opendir(depth_path.c_str() );
-    if ( NULL==rgb_dir || NULL==depth_dir) {
+    if (NULL==rgb_dir) {
         return;
     }
+    #endif
 
-    #endif  
+    if (read_depth) {
+        depth_path = path + "/depth";
+        depth_dir = opendir(depth_path.c_str() );
+        if (NULL==depth_dir) {
+            return;
+        }
+    }
 
-    #if OBSTACLE_DETECTION
-    pcd_path = path + "/pcl";
-    pcd_dir = opendir(pcd_path.c_str() );
-    if(NULL==pcd_dir) {
-        std::cerr<<"Input folder not exist\n";   
-        return;
-  }
-  #endif
-  
+    if (read_cloud) {
+        pcd_path = path + "/pcl";
+        pcd_dir = opendir(pcd_path.c_str() );
+        if(NULL==pcd_dir) {
+            std::cerr<<"Input folder not exist\n";   
+            return;
+        }
+    }
 
     // get the vector of image names, jpg/png for rgb files, .exr for depth files
     // we only read the rgb folder, and assume that the depth folder's images have the same name
-    struct dirent *dp = NULL;
     #if AR_DETECTION
-  
-    std::unordered_set<std::string> img_tails({".exr", ".jpg"}); // for rgb
     #if PERCEPTION_DEBUG
         std::cout<<"Read image names\n";
     #endif
-    do {
-        errno = 0;
-        if ((dp = readdir(rgb_dir)) != NULL) {
-        std::string file_name(dp->d_name);
-        #if PERCEPTION_DEBUG
-            std::cout<<"file_name is "<<file_name<<std::endl;
-        #endif
-        if (file_name.size() < 5) continue; // the lengh of the tail str is at least 4
-        std::string tail = file_name.substr(file_name.size()-4, 4);
-        std::string head = file_name.substr(0, file_name.size()-4);
-        if (img_tails.find(tail) != img_tails.end()) {
-            img_names.push_back(file_name);
-        }
-        }
-    } while  (dp != NULL);
-    std::sort(img_names.begin(), img_names.end());
-    #if PERCEPTION_DEBUG
-        std::cout<<"Read image names complete\n";
-    #endif
-    idx_curr_img = 0;
-
+    img_names = listFiles(rgb_dir, {".exr", ".jpg"});
+    num_frames = img_names.size();
+    #else
+    //Without images, frames are named after the depth files
+    if (read_depth) {
+        img_names = listFiles(depth_dir, {".depth", ".exr"});
+        num_frames = img_names.size();
+    }
     #endif
 
-#if OBSTACLE_DETECTION
-    dp = NULL;
-
-#if PERCEPTION_DEBUG
-    std::cout<<"Read PCL image names\n";
-#endif
-  
-do{
-    if ((dp = readdir(pcd_dir)) != NULL) {
-        std::string file_name(dp->d_name);
+    if (read_cloud) {
         #if PERCEPTION_DEBUG
-            std::cout<<"file_name is "<<file_name<<std::endl;
+            std::cout<<"Read PCL image names\n";
         #endif
-      
-        // the lengh of the tail str is at least 4
-        if (file_name.size() < 5) continue;
+        pcd_names = listFiles(pcd_dir, {".pcd"});
 
-        pcd_names.push_back(file_name);
-      
+        //The last two clouds of a recording are left out
+        size_t num_pcd_frames = pcd_names.size() > 2 ? pcd_names.size() - 2 : 0;
+        num_frames = read_depth ? std::min(num_frames, num_pcd_frames) : num_pcd_frames;
     }
 
-} while (dp != NULL);
-
-    std::sort(pcd_names.begin(), pcd_names.end());
-    #if PERCEPTION_DEBUG
-        std::cout<<"Read .pcd image names complete\n";
-    #endif
-    idx_curr_pcd_img = 0;
-    
-#endif
+    loader_.reset(new FrameLoader(num_frames, [this](size_t idx, OfflineFrame &frame) { decode(idx, frame); },
+                                  config["offline"]["loader_threads"].GetInt(),
+                                  config["offline"]["prefetch_frames"].GetInt(),
+                                  (size_t)config["offline"]["cache_mb"].GetInt() << 20));
 }
 
 bool Camera::Impl::grab() {
+    #if OBSTACLE_DETECTION
+    cloudGrabbed_ = false;
+    #endif
+    idx_curr_frame++;
+    if (idx_curr_frame >= num_frames) {
+        std::cerr<<"Ran out of images\n";
+        return false;
+    }
 
-    bool end = true;
+    //Usually already decoded while the last frame was being processed
+    frame_ = &loader_->get(idx_curr_frame);
+    return true;
+}
+
+//Starts the dataset over from its first frame
+void Camera::Impl::rewind() {
+    idx_curr_frame = 0;
+}
 
+void Camera::Impl::decode(size_t idx, OfflineFrame &frame) {
     #if AR_DETECTION
-    idx_curr_img++;
-    if (idx_curr_img >= img_names.size()) {
-        std::cout<<"Ran out of images\n";
-        end = false;
-    }
+    frame.rgb = loadImage(idx);
+    #endif
+
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    if (read_depth) frame.depth = loadDepth(idx);
     #endif
 
     #if OBSTACLE_DETECTION
-    idx_curr_pcd_img++;
-    if (idx_curr_pcd_img >= pcd_names.size()-2) {
-        std::cout<<"Ran out of images\n";
-        end = false;  
-    }
+    if (read_cloud) loadCloud(idx, frame);
     #endif
-    if(!end){
-        exit(1);
+}
+
+std::vector<std::string> Camera::Impl::listFiles(DIR *dir, const std::unordered_set<std::string> &tails) {
+    std::vector<std::string> names;
+    struct dirent *dp = NULL;
+    while ((dp = readdir(dir)) != NULL) {
+        std::string file_name(dp->d_name);
+        #if PERCEPTION_DEBUG
+            std::cout<<"file_name is "<<file_name<<std::endl;
+        #endif
+        size_t dot = file_name.rfind('.');
+        if (dot != std::string::npos && dot > 0 && tails.count(file_name.substr(dot))) {
+            names.push_back(file_name);
+        }
     }
-    return end;
+    std::sort(names.begin(), names.end());
+    return names;
 }
 
+//Mats share the decoded frame, callers copy them before changing them
 #if AR_DETECTION
 cv::Mat Camera::Impl::image() {
-    std::string full_path = rgb_path + std::string("/") + (img_names[idx_curr_img]);
+    return frame_->rgb;
+}
+#endif
+
+#if AR_DETECTION || OBSTACLE_DETECTION
+cv::Mat Camera::Impl::depth() {
+    return frame_->depth;
+}
+#endif
+
+#if AR_DETECTION
+
+cv::Mat Camera::Impl::loadImage(size_t idx) {
+    std::string full_path = rgb_path + std::string("/") + (img_names[idx]);
     #if PERCEPTION_DEBUG
-        cout << img_names[idx_curr_img] << "\n";
+        cout << img_names[idx] << "\n";
         cout << full_path << "\n";
     #endif
     cv::Mat img = cv::imread(full_path.c_str(), CV_LOAD_IMAGE_COLOR);
@@ -313,21 +426,29 @@ cv::Mat Camera::Impl::image() {
     }
     return img;
 }
+#endif
 
-cv::Mat Camera::Impl::depth() {
-    std::string rgb_name = img_names[idx_curr_img];
-    std::string full_path = depth_path + std::string("/") +
-                            rgb_name.substr(0, rgb_name.size()-4) + std::string(".exr");
+#if AR_DETECTION || OBSTACLE_DETECTION
+cv::Mat Camera::Impl::loadDepth(size_t idx) {
+    std::string name = img_names[idx];
+    std::string stem = depth_path + std::string("/") + name.substr(0, name.rfind('.'));
     #if PERCEPTION_DEBUG
-        std::cout<<full_path<<std::endl;
+        std::cout<<stem<<std::endl;
     #endif
-    cv::Mat img = cv::imread(full_path.c_str(), cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH);
+    //Frames recorded by FrameRecorder, older recordings are EXR
+    cv::Mat img = readRawDepth(stem + std::string(".depth"));
+    if (img.data) return img;
+
+    std::string full_path = stem + std::string(".exr");
+    img = cv::imread(full_path.c_str(), cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH);
     if (!img.data){
         std::cerr<<"Load image "<<full_path<< " error\n";
     }
     return img;
 }
+#endif
 
+#if AR_DETECTION
 void Camera::record_ar_init() {
   //initializing ar tag videostream object
   std::pair<Tag, Tag> tp;
@@ -366,25 +487,66 @@ void Camera::record_ar_finish() {
 #endif
 
 
-//Reads the point data cloud p_pcl_point_cloud
+//Reads the point data cloud into cloud
 #if OBSTACLE_DETECTION
-void Camera::Impl::dataCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud){
+void Camera::Impl::dataCloud(CompactCloud &cloud, int width, int height){
+  cloudGrabbed_ = true;
+
+  //Copies into the caller's cloud so it keeps its allocation
+  //Recordings are at whatever size the governor grabbed, so thin by each frame's own size
+  size_t recordedArea = frame_->recordedArea;
+  size_t requested = (size_t)width * height;
+  if (requested >= recordedArea) {
+    cloud = frame_->cloud;
+    return;
+  }
+
+  //Smaller clouds than recorded are asked for by the resolution governor, keep
+  //an evenly spread requested / recorded share of the points like the ZED would
+  const CompactCloud &recorded = frame_->cloud;
+  cloud.clear();
+  size_t step = 0;
+  for (size_t i = 0; i < recorded.size(); ++i) {
+    step += requested;
+    if (step >= recordedArea) {
+      step -= recordedArea;
+      cloud.push_back(recorded.x[i], recorded.y[i], recorded.z[i]);
+    }
+  }
+}
+
+void Camera::Impl::loadCloud(size_t idx, OfflineFrame &frame){
  
  //Read in image names
- std::string pcd_name = pcd_names[idx_curr_pcd_img];
+ std::string pcd_name = pcd_names[idx];
  std::string full_path = pcd_path + std::string("/") + pcd_name;
   //Load in the file  
-  if (pcl::io::loadPCDFile<pcl::PointXYZRGB> (full_path, *p_pcl_point_cloud) == -1){ //* load the file 
+  pcl::PointCloud<pcl::PointXYZRGB> pcd;
+  if (pcl::io::loadPCDFile<pcl::PointXYZRGB> (full_path, pcd) == -1){ //* load the file 
     PCL_ERROR ("Couldn't read file test_pcd.pcd \n"); 
   }
+
+  //Organized clouds keep the width and height they were grabbed at
+  frame.recordedArea = (size_t)pcd.width * pcd.height;
+
+  //Recorded clouds are unfiltered so crop them the same way as live frames
+  cropInPlace(bounds_, pcd);
+  fromPCL(pcd, frame.cloud);
+}
+
+//The decoded frame only keeps the compact cloud, so re-recording a dataset
+//reads the colored .pcd file again. Only done for frames being recorded.
+bool Camera::Impl::recordCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud){
+  if (!cloudGrabbed_) return false;
+  std::string full_path = pcd_path + std::string("/") + pcd_names[idx_curr_frame];
+  return pcl::io::loadPCDFile<pcl::PointXYZRGB>(full_path, cloud) != -1;
 }
 #endif
 
 #endif
 
-Camera::Camera(const rapidjson::Document &config) : 
-    impl_{new Camera::Impl(config)}, rgb_foldername{""}, depth_foldername{""}, pcl_foldername{""} , mRoverConfig( config ),
-            FRAME_WRITE_INTERVAL{mRoverConfig["camera"]["frame_write_interval"].GetInt()} {}
+Camera::Camera(const rapidjson::Document &config, const std::string &folder) : 
+    impl_{new Camera::Impl(config, folder)}, mRoverConfig( config ) {}
 
 Camera::~Camera() {
 	delete this->impl_;
@@ -394,63 +556,30 @@ bool Camera::grab() {
 	return this->impl_->grab();
 }
 
+#if !ZED_SDK_PRESENT
+void Camera::rewind() {
+	this->impl_->rewind();
+}
+#endif
+
 #if AR_DETECTION
 cv::Mat Camera::image() {
 	return this->impl_->image();
 }
+#endif
 
+#if AR_DETECTION || OBSTACLE_DETECTION
 cv::Mat Camera::depth() {
 	return this->impl_->depth();
 }
 #endif
 
 #if OBSTACLE_DETECTION
-void Camera::getDataCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud) {
-    this->impl_->dataCloud(p_pcl_point_cloud);
+void Camera::getDataCloud(CompactCloud &cloud, int width, int height) {
+    this->impl_->dataCloud(cloud, width, height);
 }
-#endif
-
-#if WRITE_CURR_FRAME_TO_DISK && AR_DETECTION && OBSTACLE_DETECTION
-
-// creates and opens folder to write to
-void Camera::disk_record_init() {
-    //defining directories to write to
-    rgb_foldername = DEFAULT_ONLINE_DATA_FOLDER "rgb/";
-    depth_foldername = DEFAULT_ONLINE_DATA_FOLDER "depth/";
-    string mkdir_rgb =  std::string("mkdir -p ") + rgb_foldername;
-    string mkdir_depth =  std::string("mkdir -p ") + depth_foldername;
-    pcl_foldername = DEFAULT_ONLINE_DATA_FOLDER "pcl/";
-    string mkdir_pcl = std::string("mkdir -p ") + pcl_foldername;
 
-    //creates new folder in the system
-    if (-1 == system(mkdir_pcl.c_str()) || -1 == system( mkdir_rgb.c_str()) || -1 == system(mkdir_depth.c_str())) 
-    {
-        exit(1);
-    }
+bool Camera::getRecordCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud) {
+    return this->impl_->recordCloud(cloud);
 }
-
-//writes the Mat to a file
-
-//Writes point cloud data to data folder specified in build tag 
-void pcl_write(const cv::String &filename, pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud){
-    #if PERCEPTION_DEBUG
-        std::cout << "name of path is: " << filename << endl;
-    #endif
-    try{ pcl::io::savePCDFileASCII (filename, *p_pcl_point_cloud); }
-    catch (pcl::IOException &e){
-        cout << e.what();
-    }
-}
-
-void Camera::write_curr_frame_to_disk(cv::Mat rgb, cv::Mat depth, pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud, int counter){
-    string fileName = to_string(counter / FRAME_WRITE_INTERVAL);
-    while(fileName.length() < 4){
-        fileName = '0'+fileName;
-    }
-
-    pcl_write(pcl_foldername + fileName + std::string(".pcd"), p_pcl_point_cloud);
-    cv::imwrite(rgb_foldername +  fileName + std::string(".jpg"), rgb );
-    cv::imwrite(depth_foldername +  fileName + std::string(".exr"), depth );
-}
-
 #endif
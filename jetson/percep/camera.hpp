@@ -1,6 +1,7 @@
 #pragma once
 #include "perception.hpp"
 #include "rapidjson/document.h"
+#include "compact_cloud.hpp"
 
 #if OBSTACLE_DETECTION
 	#include <pcl/common/common_headers.h>
@@ -10,33 +11,35 @@ class Camera {
 private:
 	class Impl;
 	Impl *impl_;
-	std::string rgb_foldername;
-	std::string depth_foldername;
-	std::string pcl_foldername;
 	cv::VideoWriter vidWrite;
 
     //reference to config file
     const rapidjson::Document& mRoverConfig;
 	
 public:
-
-	int FRAME_WRITE_INTERVAL;
-
-	Camera(const rapidjson::Document &config);
+	//folder is the dataset to read when there is no ZED, asked for on stdin if empty
+	Camera(const rapidjson::Document &config, const std::string &folder = "");
 	~Camera();
 
+	//Returns false once an offline dataset runs out of frames
 	bool grab();
 
+	#if !ZED_SDK_PRESENT
+	//Starts an offline dataset over from its first frame
+	void rewind();
+	#endif
+
 	cv::Mat image();
 	cv::Mat depth();
 	
 	#if OBSTACLE_DETECTION
-	void getDataCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud);
-	#endif
+	//Fills cloud with a width x height grab cropped to the pt_cloud pass through bounds
+	void getDataCloud(CompactCloud &cloud, int width, int height);
 
-	#if WRITE_CURR_FRAME_TO_DISK && AR_DETECTION && OBSTACLE_DETECTION
-	void disk_record_init();
-	void write_curr_frame_to_disk(cv::Mat rgb, cv::Mat depth, pcl::PointCloud<pcl::PointXYZRGB>::Ptr &p_pcl_point_cloud, int counter);
+	//Fills cloud with the cloud getDataCloud grabbed since the last grab, before
+	//cropping and compaction and with color, the way datasets are recorded
+	//Returns false if getDataCloud wasn't called for this grab
+	bool getRecordCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud);
 	#endif
 
 	void record_ar_init();
@@ -0,0 +1,28 @@
+#include "compact_cloud.hpp"
+
+#if OBSTACLE_DETECTION
+
+void fromPCL(const pcl::PointCloud<pcl::PointXYZRGB> &in, CompactCloud &out) {
+    out.resize(in.points.size());
+    for (size_t i = 0; i < in.points.size(); ++i) {
+        out.x[i] = toCompact(in.points[i].x);
+        out.y[i] = toCompact(in.points[i].y);
+        out.z[i] = toCompact(in.points[i].z);
+    }
+}
+
+void toPCL(const CompactCloud &in, pcl::PointCloud<pcl::PointXYZRGB> &out) {
+    out.points.resize(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        pcl::PointXYZRGB &pt = out.points[i];
+        pt.x = in.x[i];
+        pt.y = in.y[i];
+        pt.z = in.z[i];
+        pt.r = pt.g = pt.b = 200;
+    }
+    out.width = in.size();
+    out.height = 1;
+    out.is_dense = true;
+}
+
+#endif
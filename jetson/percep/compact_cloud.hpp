@@ -0,0 +1,75 @@
+#pragma once
+
+#include "config.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if OBSTACLE_DETECTION
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#endif
+
+/* --- Compact Cloud --- */
+/**
+\brief Point cloud stored as int16 mm coordinates, one array per axis
+The obstacle stages only need positions within a few metres, so a point
+takes 6 bytes here against 32 for pcl::PointXYZRGB, and each stage streams
+through the axes it reads. Clouds are converted to PCL types only where PCL
+itself needs them: reading and writing .pcd files.
+*/
+struct CompactCloud {
+    std::vector<int16_t> x;
+    std::vector<int16_t> y;
+    std::vector<int16_t> z;
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+    }
+
+    void resize(size_t n) {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+    }
+
+    //Allocates room for n points up front so later grabs fit without reallocating
+    void reserve(size_t n) {
+        x.reserve(n);
+        y.reserve(n);
+        z.reserve(n);
+    }
+
+    size_t capacity() const { return x.capacity(); }
+
+    void push_back(int16_t px, int16_t py, int16_t pz) {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+    }
+
+    //Copies point from into slot to, for compacting in place
+    void move(size_t to, size_t from) {
+        x[to] = x[from];
+        y[to] = y[from];
+        z[to] = z[from];
+    }
+};
+
+//Rounds a coordinate in mm to the nearest int16, saturating outside +/- 32 m
+inline int16_t toCompact(float mm) {
+    float clamped = mm < -32768.0f ? -32768.0f : (mm > 32767.0f ? 32767.0f : mm);
+    return (int16_t)std::lrint(clamped);
+}
+
+#if OBSTACLE_DETECTION
+//Converts for .pcd files, color is lost on the way in and gray on the way out
+//Recordings keep color by writing Camera::getRecordCloud instead of toPCL
+void fromPCL(const pcl::PointCloud<pcl::PointXYZRGB> &in, CompactCloud &out);
+void toPCL(const CompactCloud &in, pcl::PointCloud<pcl::PointXYZRGB> &out);
+#endif
@@ -0,0 +1,98 @@
+#include "debug_stream.hpp"
+
+#if OBSTACLE_DETECTION
+
+using namespace std;
+
+DebugCloudStream::DebugCloudStream(const rapidjson::Document &config, lcm::LCM &lcm) :
+    ENABLED{config["debug_stream"]["enabled"].GetInt() != 0},
+    CHANNEL{config["debug_stream"]["channel"].GetString()},
+    MIN_INTERVAL{chrono::duration_cast<chrono::steady_clock::duration>(
+        chrono::duration<double>(1.0 / max(config["debug_stream"]["max_rate_hz"].GetDouble(), 0.01)))},
+    VOXEL_SIZE{max(config["debug_stream"]["voxel_mm"].GetFloat(), 1.0f)},
+    QUANTIZATION{max(config["debug_stream"]["quantization_mm"].GetFloat(), 1.0f)},
+    nextSnapshot{chrono::steady_clock::now()}, busy{false},
+    lcm_(lcm), stopping{false} {
+    message.half_rover_mm = config["pt_cloud"]["half_rover"].GetInt();
+    if (ENABLED) publisher = thread(&DebugCloudStream::run, this);
+}
+
+DebugCloudStream::~DebugCloudStream() {
+    if (!ENABLED) return;
+    {
+        lock_guard<mutex> lock(mut);
+        stopping = true;
+    }
+    wake.notify_one();
+    publisher.join();
+}
+
+void DebugCloudStream::submit(long seq, const CompactCloud &cloud,
+                              const vector<pcl::PointIndices> &clusters,
+                              double leftBearing, double rightBearing, double distance) {
+    if (!ENABLED || busy.load(memory_order_acquire)) return;
+    auto now = chrono::steady_clock::now();
+    if (now < nextSnapshot) return;
+    nextSnapshot = now + MIN_INTERVAL;
+
+    points = cloud;
+    labels.assign(cloud.size(), -1);
+    for (size_t cluster = 0; cluster < clusters.size() && cluster < INT16_MAX; ++cluster) {
+        for (int index : clusters[cluster].indices) labels[index] = (int16_t)cluster;
+    }
+
+    message.seq = seq;
+    message.left_bearing = leftBearing;
+    message.right_bearing = rightBearing;
+    message.distance = distance;
+
+    {
+        lock_guard<mutex> lock(mut);
+        busy.store(true, memory_order_release);
+    }
+    wake.notify_one();
+}
+
+void DebugCloudStream::run() {
+    while (true) {
+        {
+            unique_lock<mutex> lock(mut);
+            wake.wait(lock, [this] { return stopping || busy.load(memory_order_acquire); });
+            if (stopping) return;
+        }
+        pack();
+        lcm_.publish(CHANNEL, &message);
+        busy.store(false, memory_order_release);
+    }
+}
+
+//Keeps the first point to land in each voxel
+void DebugCloudStream::pack() {
+    occupied.clear();
+    message.quantization_mm = QUANTIZATION;
+    message.x.clear();
+    message.y.clear();
+    message.z.clear();
+    message.cluster.clear();
+
+    auto quantize = [this](float v) {
+        float q = round(v / QUANTIZATION);
+        return (int16_t)max(min(q, (float)INT16_MAX), (float)INT16_MIN);
+    };
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        //Coordinates fit in 16 bits, so each voxel index does too
+        uint64_t vx = (uint16_t)(int16_t)floor(points.x[i] / VOXEL_SIZE);
+        uint64_t vy = (uint16_t)(int16_t)floor(points.y[i] / VOXEL_SIZE);
+        uint64_t vz = (uint16_t)(int16_t)floor(points.z[i] / VOXEL_SIZE);
+        if (!occupied.insert((vx << 32) | (vy << 16) | vz).second) continue;
+
+        message.x.push_back(quantize(points.x[i]));
+        message.y.push_back(quantize(points.y[i]));
+        message.z.push_back(quantize(points.z[i]));
+        message.cluster.push_back(labels[i]);
+    }
+    message.num_points = message.x.size();
+}
+
+#endif
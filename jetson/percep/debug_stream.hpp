@@ -0,0 +1,64 @@
+#pragma once
+
+#include "perception.hpp"
+
+#if OBSTACLE_DETECTION
+#include "compact_cloud.hpp"
+#include "rover_msgs/PerceptionDebugCloud.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/* --- Debug Cloud Stream --- */
+/**
+\brief Streams snapshots of the obstacle cloud over LCM for a remote viewer
+Replaces the viewers that used to run inside perception. At most
+max_rate_hz times a second submit copies the working cloud and its cluster
+labels, which is the only work done on the obstacle thread. The stream's
+own thread then keeps one point per voxel_mm voxel, quantizes the points
+to quantization_mm and publishes them with the chosen path. If the last
+snapshot is still being sent the frame is skipped.
+*/
+class DebugCloudStream {
+    public:
+        DebugCloudStream(const rapidjson::Document &config, lcm::LCM &lcm);
+        ~DebugCloudStream();
+
+        //Takes a snapshot if one is due, otherwise returns straight away
+        void submit(long seq, const CompactCloud &cloud,
+                    const std::vector<pcl::PointIndices> &clusters,
+                    double leftBearing, double rightBearing, double distance);
+
+    private:
+        void run();
+
+        //Decimates and quantizes the snapshot into message
+        void pack();
+
+        bool ENABLED;
+        std::string CHANNEL;
+        std::chrono::steady_clock::duration MIN_INTERVAL;
+        float VOXEL_SIZE;
+        float QUANTIZATION;
+        std::chrono::steady_clock::time_point nextSnapshot;
+
+        //Snapshot owned by submit while busy is false and by the thread while it is true
+        CompactCloud points;
+        std::vector<int16_t> labels;
+        rover_msgs::PerceptionDebugCloud message;
+        std::atomic<bool> busy;
+
+        //Reused by pack so decimation doesn't allocate every snapshot
+        std::unordered_set<uint64_t> occupied;
+
+        lcm::LCM &lcm_;
+        std::mutex mut;
+        std::condition_variable wake;
+        bool stopping;
+        std::thread publisher;
+};
+
+#endif
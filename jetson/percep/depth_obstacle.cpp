@@ -0,0 +1,125 @@
+#include "depth_obstacle.hpp"
+#include "simd_kernels.hpp"
+#include <limits>
+
+DepthObstacleDetector::DepthObstacleDetector(const rapidjson::Document &mRoverConfig) :
+    leftBearing{0}, rightBearing{0}, distance{-1} {
+    configure(mRoverConfig);
+}
+
+void DepthObstacleDetector::configure(const rapidjson::Document &mRoverConfig) {
+    const rapidjson::Value &ptCloud = mRoverConfig["pt_cloud"];
+    MAX_FIELD_OF_VIEW_ANGLE = ptCloud["max_field_of_view_angle"].GetInt();
+    HALF_ROVER = ptCloud["half_rover"].GetInt();
+    BEARING_BIN_SIZE = ptCloud["bearing_bin_size"].GetDouble();
+
+    const rapidjson::Value &depthObstacle = mRoverConfig["depth_obstacle"];
+    CAMERA_HEIGHT = depthObstacle["camera_height_mm"].GetFloat();
+    CAMERA_TILT = depthObstacle["camera_tilt_deg"].GetDouble() * PI / 180;
+    HORIZONTAL_FOV = depthObstacle["horizontal_fov_deg"].GetDouble() * PI / 180;
+    MIN_HEIGHT = depthObstacle["min_height_mm"].GetFloat();
+    MAX_HEIGHT = depthObstacle["max_height_mm"].GetFloat();
+    MAX_RANGE = depthObstacle["max_range_mm"].GetFloat();
+    ROW_STEP = std::max(depthObstacle["row_step"].GetInt(), 1);
+    MIN_COLUMN_POINTS = std::max(depthObstacle["min_column_points"].GetInt(), 1);
+
+    blockedBins.assign((int)(2 * MAX_FIELD_OF_VIEW_ANGLE / BEARING_BIN_SIZE) + 2, 0);
+}
+
+/* --- Reduce Columns --- */
+//A pixel in row r at depth z is a point (r - cy) * z / f below the optical
+//axis, which with the camera tilted down puts it z * k(r) below the camera
+//where k(r) = (r - cy) / f * cos(tilt) + sin(tilt). k is fixed per row, so
+//the height test is one multiply and two compares per pixel, and the inner
+//loop runs branch free along the row, four columns at a time.
+void DepthObstacleDetector::reduceColumns(const cv::Mat &depth, double focalPx) {
+    const int cols = depth.cols;
+    nearest.assign(cols, std::numeric_limits<float>::infinity());
+    hits.assign(cols, 0);
+
+    //An obstacle pixel is this far below the camera
+    DepthObstacleBounds bounds;
+    bounds.maxRange = MAX_RANGE;
+    bounds.lowestDrop = CAMERA_HEIGHT - MAX_HEIGHT;
+    bounds.highestDrop = CAMERA_HEIGHT - MIN_HEIGHT;
+    const double cy = depth.rows / 2.0;
+
+    for (int r = 0; r < depth.rows; r += ROW_STEP) {
+        const float k = (float)((r - cy) / focalPx * cos(CAMERA_TILT) + sin(CAMERA_TILT));
+        sweepDepthRow(depth.ptr<float>(r), cols, k, bounds, nearest.data(), hits.data());
+    }
+}
+
+/* --- Find Clear Path --- */
+//Same polar histogram as PCL::FindClearPath with the nearest obstacle of
+//each column as the points
+void DepthObstacleDetector::findClearPath(double focalPx) {
+    const double buffer = 10; //Clearance in mm past the edge of an obstacle
+    const double halfCorridor = HALF_ROVER + buffer;
+    const int numBins = (int)blockedBins.size() - 1;
+    const double cx = nearest.size() / 2.0;
+    double centerDistance = -1;
+
+    std::fill(blockedBins.begin(), blockedBins.end(), 0);
+
+    for (size_t c = 0; c < nearest.size(); ++c) {
+        if (hits[c] < MIN_COLUMN_POINTS) continue;
+        double z = nearest[c];
+        double x = (c - cx) * z / focalPx;
+
+        if (x >= -HALF_ROVER && x <= HALF_ROVER && (centerDistance < 0 || z < centerDistance)) {
+            centerDistance = z;
+        }
+
+        //Range of bearings this column blocks
+        double low = atan((x - halfCorridor) / z) * 180 / PI + MAX_FIELD_OF_VIEW_ANGLE;
+        double high = atan((x + halfCorridor) / z) * 180 / PI + MAX_FIELD_OF_VIEW_ANGLE;
+        if (high < 0 || low >= 2 * MAX_FIELD_OF_VIEW_ANGLE) continue;
+
+        int lowBin = std::max(0, (int)(low / BEARING_BIN_SIZE));
+        int highBin = std::min(numBins - 1, (int)(high / BEARING_BIN_SIZE));
+        ++blockedBins[lowBin];
+        --blockedBins[highBin + 1];
+    }
+
+    for (int bin = 1; bin < numBins; ++bin) {
+        blockedBins[bin] += blockedBins[bin - 1];
+    }
+
+    if (centerDistance < 0) {
+        leftBearing = 0;
+        rightBearing = 0;
+        distance = -1;
+        return;
+    }
+
+    //Walk outward from center to the first clear bin on each side
+    int centerBin = (int)(MAX_FIELD_OF_VIEW_ANGLE / BEARING_BIN_SIZE);
+
+    leftBearing = -MAX_FIELD_OF_VIEW_ANGLE;
+    for (int bin = centerBin - 1; bin >= 0; --bin) {
+        if (!blockedBins[bin]) {
+            leftBearing = std::min(0.0, (bin + 1) * BEARING_BIN_SIZE - MAX_FIELD_OF_VIEW_ANGLE);
+            break;
+        }
+    }
+
+    rightBearing = MAX_FIELD_OF_VIEW_ANGLE;
+    for (int bin = centerBin; bin < numBins; ++bin) {
+        if (!blockedBins[bin]) {
+            rightBearing = std::max(0.0, bin * BEARING_BIN_SIZE - MAX_FIELD_OF_VIEW_ANGLE);
+            break;
+        }
+    }
+
+    distance = centerDistance / 1000.0;
+}
+
+/* --- Main --- */
+void DepthObstacleDetector::detect(const cv::Mat &depth) {
+    LatencyProbe probe(Stage::ObstacleDetection);
+    //Square pixels, so one focal length in pixels serves both axes
+    double focalPx = (depth.cols / 2.0) / tan(HORIZONTAL_FOV / 2);
+    reduceColumns(depth, focalPx);
+    findClearPath(focalPx);
+}
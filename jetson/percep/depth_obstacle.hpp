@@ -0,0 +1,59 @@
+#pragma once
+
+#include "perception.hpp"
+#include <vector>
+
+/* --- Depth Obstacle Detector --- */
+/**
+\brief Finds a clear path straight from the depth image
+A much cheaper stand in for the point cloud pipeline. Every row_step'th row
+of the depth image is swept once, keeping for each column the nearest pixel
+that sits between min_height_mm and max_height_mm above the ground. Ground
+is found from the camera's height and tilt rather than RANSAC, so this
+assumes flat ground near the rover. The nearest obstacle in each column
+then goes through the same bearing histogram as PCL::FindClearPath, and the
+results mean the same as PCL's.
+*/
+class DepthObstacleDetector {
+    public:
+        //Results, same meaning as in PCL
+        double leftBearing;
+        double rightBearing;
+        double distance;
+
+        DepthObstacleDetector(const rapidjson::Document &mRoverConfig);
+
+        //Reads the detection constants, call between frames to pick up a reloaded config
+        void configure(const rapidjson::Document &mRoverConfig);
+
+        //Finds the clear path in a CV_32FC1 depth image in mm
+        void detect(const cv::Mat &depth);
+
+    private:
+        //Fills nearest and hits from every row_step'th row of depth
+        void reduceColumns(const cv::Mat &depth, double focalPx);
+
+        //Turns the nearest obstacle in each column into bearings and distance
+        void findClearPath(double focalPx);
+
+        //Shared with the point cloud pipeline
+        int MAX_FIELD_OF_VIEW_ANGLE;
+        int HALF_ROVER;
+        double BEARING_BIN_SIZE;
+
+        float CAMERA_HEIGHT;
+        double CAMERA_TILT; //Radians below horizontal
+        double HORIZONTAL_FOV; //Radians
+        float MIN_HEIGHT;
+        float MAX_HEIGHT;
+        float MAX_RANGE;
+        int ROW_STEP;
+        int MIN_COLUMN_POINTS;
+
+        //Per column nearest obstacle depth in mm and how many pixels hit an obstacle
+        std::vector<float> nearest;
+        std::vector<int> hits;
+
+        //Difference array of blocked bearing bins, as in PCL
+        std::vector<int> blockedBins;
+};
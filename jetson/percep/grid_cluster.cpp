@@ -0,0 +1,162 @@
+#include "grid_cluster.hpp"
+#include "perception.hpp"
+
+#if OBSTACLE_DETECTION
+
+//Offsets of the cell itself plus the 13 neighbors that come after it in
+//lexicographic order. Visiting only these checks every pair of cells once.
+static const int FORWARD_NEIGHBORS[14][3] = {
+    { 0,  0,  0},
+    { 0,  0,  1},
+    { 0,  1, -1}, { 0,  1,  0}, { 0,  1,  1},
+    { 1, -1, -1}, { 1, -1,  0}, { 1, -1,  1},
+    { 1,  0, -1}, { 1,  0,  0}, { 1,  0,  1},
+    { 1,  1, -1}, { 1,  1,  0}, { 1,  1,  1}
+};
+
+//Cell coordinates are offset into 21 unsigned bits each, enough for
+//+/- 1 million cells on each axis
+static const int CELL_OFFSET = 1 << 20;
+static const uint64_t CELL_MASK = (1 << 21) - 1;
+
+GridClusterExtraction::GridClusterExtraction(float tolerance_in, int minSize_in, int maxSize_in) :
+    tolerance{tolerance_in}, minSize{minSize_in}, maxSize{maxSize_in} {}
+
+void GridClusterExtraction::setParameters(float tolerance_in, int minSize_in, int maxSize_in) {
+    tolerance = tolerance_in;
+    minSize = minSize_in;
+    maxSize = maxSize_in;
+}
+
+uint64_t GridClusterExtraction::cellKey(int cx, int cy, int cz) {
+    return ((uint64_t)(cx + CELL_OFFSET) & CELL_MASK) << 42 |
+           ((uint64_t)(cy + CELL_OFFSET) & CELL_MASK) << 21 |
+           ((uint64_t)(cz + CELL_OFFSET) & CELL_MASK);
+}
+
+int GridClusterExtraction::find(int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void GridClusterExtraction::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    //Lower index becomes the root so cluster order follows point order
+    if (a < b) parent[b] = a;
+    else parent[a] = b;
+}
+
+/* --- Extract --- */
+//Buckets every point by cell, then compares each cell only against its
+//forward neighbors and joins points within tolerance
+void GridClusterExtraction::extract(const CompactCloud &cloud,
+                                    std::vector<pcl::PointIndices> &clusters) {
+    clusters.clear();
+    int numPoints = (int)cloud.size();
+    //The config schema keeps the tolerance positive, this guards the divide
+    if (numPoints == 0 || !(tolerance > 0)) return;
+
+    const float invTolerance = 1.0f / tolerance;
+    const float toleranceSq = tolerance * tolerance;
+    const int16_t *xs = cloud.x.data();
+    const int16_t *ys = cloud.y.data();
+    const int16_t *zs = cloud.z.data();
+
+    //Bucket points by cell
+    cells.resize(numPoints);
+    for (int i = 0; i < numPoints; ++i) {
+        cells[i].first = cellKey((int)std::floor(xs[i] * invTolerance),
+                                 (int)std::floor(ys[i] * invTolerance),
+                                 (int)std::floor(zs[i] * invTolerance));
+        cells[i].second = i;
+    }
+    std::sort(cells.begin(), cells.end());
+
+    cellStarts.clear();
+    for (int i = 0; i < numPoints; ++i) {
+        if (i == 0 || cells[i].first != cells[i - 1].first) {
+            cellStarts.emplace_back(cells[i].first, i);
+        }
+    }
+    const int numCells = (int)cellStarts.size();
+    cellStarts.emplace_back(UINT64_MAX, numPoints);
+
+    parent.resize(numPoints);
+    for (int i = 0; i < numPoints; ++i) parent[i] = i;
+
+    //Join points within tolerance of each other
+    const auto cellsEnd = cellStarts.begin() + numCells;
+    for (int c = 0; c < numCells; ++c) {
+        const uint64_t key = cellStarts[c].first;
+        const int begin = cellStarts[c].second;
+        const int end = cellStarts[c + 1].second;
+        const int cx = (int)((key >> 42) & CELL_MASK) - CELL_OFFSET;
+        const int cy = (int)((key >> 21) & CELL_MASK) - CELL_OFFSET;
+        const int cz = (int)(key & CELL_MASK) - CELL_OFFSET;
+
+        for (const auto &offset : FORWARD_NEIGHBORS) {
+            bool self = offset[0] == 0 && offset[1] == 0 && offset[2] == 0;
+            int neighborBegin = begin;
+            int neighborEnd = end;
+            if (!self) {
+                //Forward neighbors have larger keys, so only search past this cell
+                const uint64_t neighborKey = cellKey(cx + offset[0], cy + offset[1], cz + offset[2]);
+                auto neighbor = std::lower_bound(cellStarts.begin() + c + 1, cellsEnd,
+                    std::make_pair(neighborKey, 0));
+                if (neighbor == cellsEnd || neighbor->first != neighborKey) continue;
+                neighborBegin = neighbor->second;
+                neighborEnd = (neighbor + 1)->second;
+            }
+
+            for (int a = begin; a < end; ++a) {
+                const int pa = cells[a].second;
+                for (int b = self ? a + 1 : neighborBegin; b < neighborEnd; ++b) {
+                    const int pb = cells[b].second;
+                    float dx = xs[pa] - xs[pb];
+                    float dy = ys[pa] - ys[pb];
+                    float dz = zs[pa] - zs[pb];
+                    if (dx * dx + dy * dy + dz * dz <= toleranceSq) {
+                        unite(pa, pb);
+                    }
+                }
+            }
+        }
+    }
+
+    //Count set sizes and assign accepted sets an output slot
+    rootSize.assign(numPoints, 0);
+    for (int i = 0; i < numPoints; ++i) ++rootSize[find(i)];
+
+    rootCluster.assign(numPoints, -1);
+    int numClusters = 0;
+    for (int i = 0; i < numPoints; ++i) {
+        if (parent[i] == i && rootSize[i] >= minSize && rootSize[i] <= maxSize) {
+            rootCluster[i] = numClusters++;
+        }
+    }
+
+    clusters.resize(numClusters);
+    for (int i = 0; i < numPoints; ++i) {
+        if (parent[i] == i && rootCluster[i] >= 0) {
+            clusters[rootCluster[i]].indices.reserve(rootSize[i]);
+        }
+    }
+
+    //Visiting points in order keeps each cluster's indices sorted
+    for (int i = 0; i < numPoints; ++i) {
+        int cluster = rootCluster[find(i)];
+        if (cluster >= 0) clusters[cluster].indices.push_back(i);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+        [](const pcl::PointIndices &a, const pcl::PointIndices &b) {
+            return a.indices.size() > b.indices.size();
+        });
+}
+
+#endif
@@ -0,0 +1,59 @@
+#if OBSTACLE_DETECTION
+#pragma once
+
+#include "perception.hpp"
+#include "compact_cloud.hpp"
+#include <vector>
+
+/* --- Grid Cluster Extraction --- */
+/**
+\brief Euclidean cluster extraction over a sorted voxel grid instead of a KdTree
+Points are bucketed into cubic cells one cluster tolerance wide, so every
+neighbor within tolerance of a point lies in its own cell or one of the 26
+around it. Points closer than the tolerance are joined with union-find.
+Produces the same clusters as pcl::EuclideanClusterExtraction: clusters
+outside [minSize, maxSize] are dropped, the rest are sorted largest first
+with their indices in ascending order.
+Working buffers are members so they keep their capacity between frames.
+A tolerance of zero or less has no grid and yields no clusters.
+*/
+class GridClusterExtraction {
+    public:
+        GridClusterExtraction(float tolerance, int minSize, int maxSize);
+
+        //Changes the clustering parameters, keeping the working buffers
+        void setParameters(float tolerance, int minSize, int maxSize);
+
+        //Clusters cloud and fills clusters, clusters is cleared first
+        void extract(const CompactCloud &cloud, std::vector<pcl::PointIndices> &clusters);
+
+    private:
+        //Packs integer cell coordinates into a single sortable key
+        static uint64_t cellKey(int cx, int cy, int cz);
+
+        //Finds the root of a point's set, halving the path as it goes
+        int find(int i);
+
+        //Joins the sets containing a and b
+        void unite(int a, int b);
+
+        float tolerance;
+        int minSize;
+        int maxSize;
+
+        //(cell key, point index) pairs sorted by key
+        std::vector<std::pair<uint64_t, int>> cells;
+
+        //(cell key, first index in cells) of every occupied cell sorted by key,
+        //ending with a sentinel so a cell's range ends where the next begins
+        std::vector<std::pair<uint64_t, int>> cellStarts;
+
+        //Union-find parent of every point
+        std::vector<int> parent;
+
+        //Output cluster index of every root, -1 if its cluster is rejected
+        std::vector<int> rootCluster;
+        std::vector<int> rootSize;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "perception.hpp"
+
+#if !ZED_SDK_PRESENT
+#include "loader.hpp"
+#include <cstring>
+#include <limits>
+#include <sys/mman.h>
+
+using namespace std;
+
+static const size_t NO_FRAME = numeric_limits<size_t>::max();
+
+/* --- Decoded Frame Cache --- */
+DecodedFrameCache::DecodedFrameCache(size_t capacityBytes) : region(nullptr), capacity(capacityBytes), used(0) {
+    //Reserve the whole cache now so it never moves, memory is only committed as frames are added
+    void *mapped = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapped == MAP_FAILED) {
+        cerr << "Could not map a " << capacity << " byte frame cache, frames won't be cached\n";
+        capacity = 0;
+        return;
+    }
+    region = (char *)mapped;
+}
+
+DecodedFrameCache::~DecodedFrameCache() {
+    if (region) munmap(region, capacity);
+}
+
+bool DecodedFrameCache::load(size_t index, OfflineFrame &frame) {
+    Entry entry;
+    {
+        lock_guard<mutex> lock(mut);
+        auto found = entries.find(index);
+        if (found == entries.end()) return false;
+        entry = found->second;
+    }
+
+    //Cached bytes are never written again, so they can be copied out without the lock
+    //Every frame gets fresh buffers since the consumer may still hold the last ones
+    char *data = region + entry.offset;
+
+    #if AR_DETECTION
+    frame.rgb = cv::Mat(entry.rgb.rows, entry.rgb.cols, entry.rgb.type, data).clone();
+    data += frame.rgb.total() * frame.rgb.elemSize();
+    #endif
+
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    frame.depth = cv::Mat(entry.depth.rows, entry.depth.cols, entry.depth.type, data).clone();
+    data += frame.depth.total() * frame.depth.elemSize();
+    #endif
+
+    #if OBSTACLE_DETECTION
+    frame.cloud.resize(entry.cloudPoints);
+    frame.recordedArea = entry.recordedArea;
+    for (auto axis : { &frame.cloud.x, &frame.cloud.y, &frame.cloud.z }) {
+        memcpy(axis->data(), data, entry.cloudPoints * sizeof(int16_t));
+        data += entry.cloudPoints * sizeof(int16_t);
+    }
+    #endif
+
+    return true;
+}
+
+void DecodedFrameCache::store(size_t index, const OfflineFrame &frame) {
+    if (!region) return;
+
+    Entry entry;
+    size_t bytes = 0;
+
+    //Decoded images are continuous, but copy them if they aren't so each is one memcpy
+    #if AR_DETECTION
+    cv::Mat rgb = frame.rgb.isContinuous() ? frame.rgb : frame.rgb.clone();
+    entry.rgb = { rgb.rows, rgb.cols, rgb.type() };
+    bytes += rgb.total() * rgb.elemSize();
+    #endif
+
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    //Empty when the dataset is replayed without depth
+    cv::Mat depth = frame.depth.isContinuous() ? frame.depth : frame.depth.clone();
+    entry.depth = { depth.rows, depth.cols, depth.type() };
+    bytes += depth.total() * depth.elemSize();
+    #endif
+
+    #if OBSTACLE_DETECTION
+    entry.cloudPoints = frame.cloud.size();
+    entry.recordedArea = frame.recordedArea;
+    bytes += 3 * entry.cloudPoints * sizeof(int16_t);
+    #endif
+
+    //Claim space under the lock, then copy without holding it
+    {
+        lock_guard<mutex> lock(mut);
+        if (entries.count(index) || used + bytes > capacity) return;
+        entry.offset = used;
+        used += bytes;
+    }
+
+    char *data = region + entry.offset;
+
+    #if AR_DETECTION
+    memcpy(data, rgb.data, rgb.total() * rgb.elemSize());
+    data += rgb.total() * rgb.elemSize();
+    #endif
+
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    memcpy(data, depth.data, depth.total() * depth.elemSize());
+    data += depth.total() * depth.elemSize();
+    #endif
+
+    #if OBSTACLE_DETECTION
+    for (auto axis : { &frame.cloud.x, &frame.cloud.y, &frame.cloud.z }) {
+        memcpy(data, axis->data(), entry.cloudPoints * sizeof(int16_t));
+        data += entry.cloudPoints * sizeof(int16_t);
+    }
+    #endif
+
+    lock_guard<mutex> lock(mut);
+    entries[index] = entry;
+}
+
+/* --- Frame Loader --- */
+FrameLoader::FrameLoader(size_t numFrames, Decoder decode, int threads, int prefetch, size_t cacheBytes) :
+    numFrames(numFrames),
+    decode(decode),
+    cache(cacheBytes ? new DecodedFrameCache(cacheBytes) : nullptr),
+    slots(max(prefetch, 0) + 1),
+    current(0),
+    nextToClaim(0),
+    generation(0),
+    stopping(false) {
+
+    for (auto &slot : slots) slot.index = NO_FRAME;
+    for (int i = 0; i < max(threads, 1); ++i) {
+        workers.emplace_back(&FrameLoader::work, this);
+    }
+}
+
+FrameLoader::~FrameLoader() {
+    {
+        lock_guard<mutex> lock(mut);
+        stopping = true;
+    }
+    claimable.notify_all();
+    for (auto &worker : workers) worker.join();
+}
+
+const OfflineFrame &FrameLoader::get(size_t index) {
+    unique_lock<mutex> lock(mut);
+
+    //Anything but moving forward within the ring drops the prefetched frames
+    if (index < current || index >= current + slots.size()) {
+        ++generation;
+        for (auto &slot : slots) slot.index = NO_FRAME;
+        nextToClaim = index;
+    }
+    current = index;
+    nextToClaim = max(nextToClaim, index);
+    claimable.notify_all();
+
+    Slot &slot = slots[index % slots.size()];
+    ready.wait(lock, [&]() {
+        return slot.index == index;
+    });
+    return slot.frame;
+}
+
+void FrameLoader::work() {
+    unique_lock<mutex> lock(mut);
+    while (true) {
+        //The slot a frame goes in is free once the consumer has moved past the frame a ring ago
+        claimable.wait(lock, [&]() {
+            return stopping || (nextToClaim < numFrames && nextToClaim < current + slots.size());
+        });
+        if (stopping) return;
+
+        size_t index = nextToClaim++;
+        long claimedGeneration = generation;
+        lock.unlock();
+
+        OfflineFrame frame;
+        if (!cache || !cache->load(index, frame)) {
+            decode(index, frame);
+            if (cache) cache->store(index, frame);
+        }
+
+        lock.lock();
+        //Skip frames the consumer has already gone past, their slot may hold a newer frame
+        if (claimedGeneration != generation || index < current) continue;
+        Slot &slot = slots[index % slots.size()];
+        slot.frame = std::move(frame);
+        slot.index = index;
+        ready.notify_all();
+    }
+}
+
+#endif
@@ -0,0 +1,125 @@
+#if !ZED_SDK_PRESENT
+#pragma once
+
+#include "perception.hpp"
+#include "compact_cloud.hpp"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/* --- Offline Frame --- */
+//One decoded frame of a recorded dataset
+struct OfflineFrame {
+    #if AR_DETECTION
+    cv::Mat rgb;
+    #endif
+
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    cv::Mat depth;
+    #endif
+
+    #if OBSTACLE_DETECTION
+    CompactCloud cloud;
+    //Points the cloud had before cropping, the width x height it was recorded at
+    size_t recordedArea = 0;
+    #endif
+};
+
+/* --- Decoded Frame Cache --- */
+/**
+\brief Keeps decoded frames so later passes over a dataset skip decoding
+Frames are copied into one mmap'd region reserved up front, pages are only
+backed by memory once a frame is written to them. Frames are added until
+the region is full and are never evicted, so a dataset larger than the cache
+has its first frames cached and the rest decoded every pass.
+Safe to use from any thread.
+*/
+class DecodedFrameCache {
+    public:
+        DecodedFrameCache(size_t capacityBytes);
+        ~DecodedFrameCache();
+
+        //Copies the cached frame index into frame, returns false if it isn't cached
+        bool load(size_t index, OfflineFrame &frame);
+
+        //Caches frame as index if there is room left
+        void store(size_t index, const OfflineFrame &frame);
+
+    private:
+        struct MatHeader {
+            int rows;
+            int cols;
+            int type;
+        };
+
+        struct Entry {
+            size_t offset;
+            #if AR_DETECTION
+            MatHeader rgb;
+            #endif
+            #if AR_DETECTION || OBSTACLE_DETECTION
+            MatHeader depth;
+            #endif
+            #if OBSTACLE_DETECTION
+            size_t cloudPoints;
+            size_t recordedArea;
+            #endif
+        };
+
+        char *region;
+        size_t capacity;
+        size_t used;
+        std::unordered_map<size_t, Entry> entries;
+        std::mutex mut;
+};
+
+/* --- Frame Loader --- */
+/**
+\brief Decodes the frames after the current one on a pool of threads
+Frames are expected to be asked for in order. While the consumer works on
+one frame, up to prefetch frames after it are decoded into a ring so the next
+get usually returns without touching the disk. Asking for a frame outside
+the ring, like starting the dataset over, drops what was prefetched and
+starts again from there.
+*/
+class FrameLoader {
+    public:
+        //Fills frame with the decoded frame at index, called from the loader threads
+        typedef std::function<void(size_t index, OfflineFrame &frame)> Decoder;
+
+        FrameLoader(size_t numFrames, Decoder decode, int threads, int prefetch, size_t cacheBytes);
+        ~FrameLoader();
+
+        //Waits for frame index to be decoded and returns it
+        //The frame stays valid until the next call
+        const OfflineFrame &get(size_t index);
+
+    private:
+        struct Slot {
+            size_t index;
+            OfflineFrame frame;
+        };
+
+        void work();
+
+        size_t numFrames;
+        Decoder decode;
+        std::unique_ptr<DecodedFrameCache> cache;
+
+        std::vector<Slot> slots;
+        size_t current;     //Frame the consumer holds, the ring covers the frames after it
+        size_t nextToClaim; //Next frame a loader thread should decode
+        long generation;    //Bumped when the ring is dropped so in flight frames are discarded
+        bool stopping;
+
+        std::mutex mut;
+        std::condition_variable claimable;
+        std::condition_variable ready;
+        std::vector<std::thread> workers;
+};
+
+#endif
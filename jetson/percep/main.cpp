@@ -1,75 +1,83 @@
 #include "perception.hpp"
+#include "pipeline.hpp"
+#include "recorder.hpp"
+#include "resolution_governor.hpp"
+#include "depth_obstacle.hpp"
+#include "debug_stream.hpp"
+#include "percep_config.hpp"
+#include "rover_msgs/ConfigReload.hpp"
+#include "rover_msgs/PerceptionRecord.hpp"
 #include "rover_msgs/Target.hpp"
 #include "rover_msgs/TargetList.hpp"
 #include <unistd.h>
+#include <cassert>
 #include <deque>
 
 using namespace cv;
 using namespace std;
 using namespace std::chrono_literals;
+
+//Turns frame recording on or off when asked to over LCM
+static void onRecordRequest(const lcm::ReceiveBuffer*, const string&, const rover_msgs::PerceptionRecord* request,
+                            FrameRecorder* recorder) {
+    recorder->setEnabled(request->enabled);
+    cout << "Frame recording " << (request->enabled ? "on" : "off") << endl;
+}
+
+//Validates a new config from LCM, the stages pick it up at their next frame
+static void onConfigReload(const lcm::ReceiveBuffer*, const string&, const rover_msgs::ConfigReload* reload,
+                           ConfigUpdates* updates) {
+    string error;
+    if (updates->update(reload->config, error)) cout << "Config reloaded" << endl;
+    else cerr << "Config reload rejected: " << error << endl;
+}
  
 int main() {
   
  /* --- Reading in Config File --- */
   rapidjson::Document mRoverConfig;
-  ifstream configFile;
-  string configPath = getenv("MROVER_CONFIG");
-  configPath += "/config_percep/config.json";
-  configFile.open( configPath );
-  string config = "";
-  string setting;
-  while( configFile >> setting ) {
-    config += setting;
+  string configError;
+  if (!loadConfig(configPath(), mRoverConfig, configError)) {
+    cerr << "Error: " << configError << endl;
+    return 1;
   }
-  configFile.close();
-  mRoverConfig.Parse( config.c_str() );
 
   /* --- Camera Initializations --- */
     Camera cam(mRoverConfig);
-    int iterations = 0;
     cam.grab();
 
-    #if PERCEPTION_DEBUG
-        namedWindow("depth", 2);
-    #endif
-    
-    #if AR_DETECTION
-    Mat rgb;
-    Mat src = cam.image();
-    #endif
-
-    #if WRITE_CURR_FRAME_TO_DISK && AR_DETECTION && OBSTACLE_DETECTION
-        cam.disk_record_init();
-    #endif
-
     /* -- LCM Messages Initializations -- */
+    //lcm publish is thread safe, each stage publishes its own channel
     lcm::LCM lcm_;
-    rover_msgs::TargetList arTagsMessage;
-    rover_msgs::Target* arTags = arTagsMessage.targetList;
-    rover_msgs::Obstacle obstacleMessage;
-    arTags[0].distance = mRoverConfig["ar_tag"]["default_tag_val"].GetInt();
-    arTags[1].distance = mRoverConfig["ar_tag"]["default_tag_val"].GetInt();
+
+    /* --- Frame Recording Initializations --- */
+    //write_frame only picks whether recording starts on, it can be switched over LCM while running
+    FrameRecorder recorder(mRoverConfig, DEFAULT_ONLINE_DATA_FOLDER, WRITE_CURR_FRAME_TO_DISK);
+    lcm_.subscribeFunction(mRoverConfig["recorder"]["channel"].GetString(), onRecordRequest, &recorder);
+
+    /* --- Config Reload Initializations --- */
+    //Detection constants can be retuned while running, camera and pipeline settings take a restart
+    ConfigUpdates configUpdates;
+    lcm_.subscribeFunction(mRoverConfig["config_channel"].GetString(), onConfigReload, &configUpdates);
 
     /* --- AR Tag Initializations --- */
     TagDetector detector(mRoverConfig);
-    pair<Tag, Tag> tagPair;
     
     /* --- Point Cloud Initializations --- */
     #if OBSTACLE_DETECTION
 
     PCL pointcloud(mRoverConfig);
-    enum viewerType {
-        newView, //set to 0 -or false- to be passed into updateViewer later
-        originalView //set to 1 -or true- to be passed into updateViewer later
-    };
 
-    /* --- Outlier Detection --- */
-    int numChecks = 3;
-    deque <bool> outliers;
-    outliers.resize(numChecks, true); //initializes outliers vector
-    deque <bool> checkTrue(numChecks, true); //true deque to check our outliers deque against
-    deque <bool> checkFalse(numChecks, false); //false deque to check our outliers deque against
-    obstacle_return lastObstacle;
+    //Trades cloud detail for detection time, capture asks it what size cloud to grab
+    ResolutionGovernor governor(mRoverConfig);
+    string GOVERNOR_CHANNEL = mRoverConfig["governor"]["channel"].GetString();
+
+    //Clear path straight from the depth image instead of the point cloud
+    bool DEPTH_OBSTACLES = mRoverConfig["depth_obstacle"]["enabled"].GetInt() != 0;
+    DepthObstacleDetector depthObstacles(mRoverConfig);
+
+    //Sends the processed cloud to jetson_percep_viewer, off the obstacle thread
+    DebugCloudStream debugStream(mRoverConfig, lcm_);
 
     #endif
 
@@ -84,70 +92,227 @@ int main() {
     cam.record_ar_init();
     #endif
 
-  /* --- Main Processing Stuff --- */
-  while (true) {
+    /* --- Pipeline Initializations --- */
+    //Each stage gets its own queue so a slow stage only drops its own frames
+    size_t QUEUE_DEPTH = mRoverConfig["pipeline"]["queue_depth"].GetInt();
+    FrameQueue<shared_ptr<Frame>> arQueue(QUEUE_DEPTH);
+    FrameQueue<shared_ptr<Frame>> obstacleQueue(QUEUE_DEPTH);
+
+    //Frames are recycled once both stages are done with them
+    BufferPool<Frame> framePool;
+    SteadyStateCheck steadyState(mRoverConfig["pipeline"]["pool_warmup_frames"].GetInt());
+
+    atomic<bool> capturing(true);
+
+  /* --- Capture Stage --- */
+  //Grabs frames, copies them out of the camera's buffers and hands them to each stage
+  thread captureThread([&]() {
+    long seq = 0;
+    while (true) {
+        auto grabTime = chrono::steady_clock::now();
+
         //Check to see if we were able to grab the frame
         if (!cam.grab()) break;
 
+        shared_ptr<Frame> frame = framePool.acquire();
+        frame->seq = seq;
+        frame->grabTime = grabTime;
+        steadyState.before(*frame);
+
+        //Camera reuses its image buffers on the next grab so stages get their own copy
+        //copyTo only allocates the first time a pooled frame is used
         #if AR_DETECTION
-        //Grab initial images from cameras
-        Mat rgb;
-        Mat src = cam.image();
-        Mat depth_img = cam.depth();
+        cam.image().copyTo(frame->rgb);
+        cam.depth().copyTo(frame->depth);
+        #elif OBSTACLE_DETECTION
+        if (DEPTH_OBSTACLES) cam.depth().copyTo(frame->depth);
         #endif
 
         #if OBSTACLE_DETECTION
-        //Update Point Cloud
-        pointcloud.update();
-        cam.getDataCloud(pointcloud.pt_cloud_ptr);
+        //The depth image copied above is all the depth obstacle mode needs
+        if (!DEPTH_OBSTACLES) {
+            //Sized for the governor's biggest level so changing level doesn't reallocate
+            frame->cloud.reserve(governor.maxCloudPoints());
+            OperatingPoint operatingPoint = governor.point();
+            cam.getDataCloud(frame->cloud, operatingPoint.cloudWidth, operatingPoint.cloudHeight);
+        }
         #endif
 
-        #if WRITE_CURR_FRAME_TO_DISK && AR_DETECTION && OBSTACLE_DETECTION
-        int FRAME_WRITE_INTERVAL = mRoverConfig["camera"]["frame_write_interval"].GetInt();
-            if (iterations % FRAME_WRITE_INTERVAL == 0) {
-                Mat rgb_copy = src.clone(), depth_copy = depth_img.clone();
-                #if PERCEPTION_DEBUG
-                    cout << "Copied correctly" << endl;
-                #endif
-                cam.write_curr_frame_to_disk(rgb_copy, depth_copy, pointcloud.pt_cloud_ptr, iterations);
+        //Once every stage has had a few frames in flight nothing should allocate
+        //Debug builds stop here so a regression can't go unnoticed
+        bool steady = steadyState.after(seq, *frame, framePool.allocations());
+        if (!steady) {
+            cerr << "Frame " << seq << " allocated in steady state, the pool is at "
+                 << framePool.allocations() << " frames\n";
         }
+        assert(steady);
+
+        telemetry()[Stage::Grab].record(chrono::steady_clock::now() - grabTime);
+
+        //Only copies the frame out, the recorder writes it on its own thread
+        recorder.submit(*frame, cam);
+
+        #if OBSTACLE_DETECTION
+        obstacleQueue.push(frame);
         #endif
 
-        /* --- AR Tag Processing --- */
-        arTags[0].distance = mRoverConfig["ar_tag"]["default_tag_val"].GetInt();
-        arTags[1].distance = mRoverConfig["ar_tag"]["default_tag_val"].GetInt();
+        //AR stage publishes default targets even when tag detection is off
+        arQueue.push(std::move(frame));
+
+        #if !ZED_SDK_PRESENT
+            std::this_thread::sleep_for(0.2s); // Iteration speed control not needed when using camera 
+        #endif
+
+        ++seq;
+    }
+
+    arQueue.close();
+    obstacleQueue.close();
+    capturing = false;
+  });
+
+  /* --- Telemetry --- */
+  //Publishes stage latency percentiles until capture stops
+  thread telemetryThread([&]() {
+    auto TELEMETRY_INTERVAL = chrono::milliseconds(mRoverConfig["telemetry"]["publish_interval_ms"].GetInt());
+    string TELEMETRY_CHANNEL = mRoverConfig["telemetry"]["channel"].GetString();
+    while (capturing) {
+        this_thread::sleep_for(TELEMETRY_INTERVAL);
+        telemetry().publish(lcm_, TELEMETRY_CHANNEL, arQueue.dropped() + obstacleQueue.dropped());
+    }
+  });
+
+  /* --- LCM Handling --- */
+  //Receives recording requests until capture stops
+  thread lcmThread([&]() {
+    while (capturing) {
+        lcm_.handleTimeout(100);
+    }
+  });
+
+  #if PERCEPTION_DEBUG && AR_DETECTION
+  //HighGUI isn't thread safe, so the AR stage hands frames to the main thread to show
+  FrameQueue<shared_ptr<Frame>> displayQueue(1);
+  #endif
+
+  /* --- AR Tag Stage --- */
+  thread arThread([&]() {
+    rover_msgs::TargetList arTagsMessage;
+    rover_msgs::Target* arTags = arTagsMessage.targetList;
+    arTags[0].distance = detector.DEFAULT_TAG_VAL;
+    arTags[1].distance = detector.DEFAULT_TAG_VAL;
+    pair<Tag, Tag> tagPair;
+    long configVersion = 0;
+
+    #if !OBSTACLE_DETECTION
+    //Nav expects /obstacle every frame, so without obstacle detection report a clear path
+    rover_msgs::Obstacle clearPath;
+    obstacle_return noObstacle;
+    clearPath.bearing = noObstacle.leftBearing;
+    clearPath.rightBearing = noObstacle.rightBearing;
+    clearPath.distance = noObstacle.distance;
+    #endif
+
+    shared_ptr<Frame> frame;
+    Mat rgb; //Reused every frame so the conversion doesn't reallocate
+    while (arQueue.pop(frame)) {
+        if (auto config = configUpdates.poll(configVersion)) detector.configure(*config);
+        arTags[0].distance = detector.DEFAULT_TAG_VAL;
+        arTags[1].distance = detector.DEFAULT_TAG_VAL;
+
         #if AR_DETECTION
-            tagPair = detector.findARTags(src, depth_img, rgb);
+            tagPair = detector.findARTags(frame->rgb, frame->depth, rgb);
             #if AR_RECORD
                 cam.record_ar(rgb);
             #endif
 
-            detector.updateDetectedTagInfo(arTags, tagPair, depth_img, src);
+            detector.updateDetectedTagInfo(arTags, tagPair, frame->depth, frame->rgb);
 
-        #if PERCEPTION_DEBUG && AR_DETECTION
-            imshow("depth", src);
-            waitKey(1);  
+        #if PERCEPTION_DEBUG
+            displayQueue.push(frame);
         #endif
 
         #endif
 
-        /* --- Point Cloud Processing --- */
-        #if OBSTACLE_DETECTION && !WRITE_CURR_FRAME_TO_DISK
-        
-        #if PERCEPTION_DEBUG
-            //Update Original 3D Viewer
-            pointcloud.updateViewer(originalView);
-            cout<<"Original W: " <<pointcloud.pt_cloud_ptr->width<<" Original H: "<<pointcloud.pt_cloud_ptr->height<<endl;
+        lcm_.publish("/target_list", &arTagsMessage);
+        #if !OBSTACLE_DETECTION
+        lcm_.publish("/obstacle", &clearPath);
         #endif
+        telemetry()[Stage::ARFrameAge].record(chrono::steady_clock::now() - frame->grabTime);
+    }
+
+    #if PERCEPTION_DEBUG && AR_DETECTION
+    displayQueue.close();
+    #endif
+  });
+
+  /* --- Obstacle Stage --- */
+  #if OBSTACLE_DETECTION
+  thread obstacleThread([&]() {
+    rover_msgs::Obstacle obstacleMessage;
+    rover_msgs::PerceptionGovernor governorMessage;
+
+    /* --- Outlier Detection --- */
+    int numChecks = 3;
+    deque <bool> outliers;
+    outliers.resize(numChecks, true); //initializes outliers vector
+    deque <bool> checkTrue(numChecks, true); //true deque to check our outliers deque against
+    deque <bool> checkFalse(numChecks, false); //false deque to check our outliers deque against
+    obstacle_return lastObstacle;
+    long configVersion = 0;
 
-        //Run Obstacle Detection
-        pointcloud.pcl_obstacle_detection();  
-        obstacle_return obstacleOutput (pointcloud.leftBearing, pointcloud.rightBearing, pointcloud.distance);
+    //The depth obstacle mode has no cloud, but still streams its paths
+    const CompactCloud noCloud;
+    const vector<pcl::PointIndices> noClusters;
+
+    shared_ptr<Frame> frame;
+    while (obstacleQueue.pop(frame)) {
+        if (auto config = configUpdates.poll(configVersion)) {
+            pointcloud.configure(*config);
+            depthObstacles.configure(*config);
+        }
+
+        obstacle_return obstacleOutput;
+        if (DEPTH_OBSTACLES) {
+            depthObstacles.detect(frame->depth);
+            obstacleOutput = obstacle_return(depthObstacles.leftBearing, depthObstacles.rightBearing, depthObstacles.distance);
+            debugStream.submit(frame->seq, noCloud, noClusters,
+                               depthObstacles.leftBearing, depthObstacles.rightBearing, depthObstacles.distance);
+        }
+        else {
+            //The governor owns the voxel size and RANSAC iterations while it is on
+            if (governor.enabled()) {
+                OperatingPoint operatingPoint = governor.point();
+                pointcloud.LEAF_SIZE = operatingPoint.leafSize;
+                pointcloud.MAX_ITERATIONS = operatingPoint.ransacIterations;
+            }
+
+            pointcloud.input = &frame->cloud;
+
+            #if PERCEPTION_DEBUG
+                cout<<"Frame: " << frame->seq << " Original points: " <<frame->cloud.size()<<endl;
+            #endif
+
+            //Run Obstacle Detection
+            auto detectionStart = chrono::steady_clock::now();
+            pointcloud.pcl_obstacle_detection();  
+            if (governor.record(chrono::steady_clock::now() - detectionStart)) {
+                governor.status(governorMessage);
+                lcm_.publish(GOVERNOR_CHANNEL, &governorMessage);
+            }
+            obstacleOutput = obstacle_return(pointcloud.leftBearing, pointcloud.rightBearing, pointcloud.distance);
+            debugStream.submit(frame->seq, pointcloud.cloud, pointcloud.clusterIndices,
+                               pointcloud.leftBearing, pointcloud.rightBearing, pointcloud.distance);
+
+            #if PERCEPTION_DEBUG
+            cout<<"Downsampled points: " <<pointcloud.cloud.size()<<endl;
+            #endif
+        }
 
         //Outlier Detection Processing
         outliers.pop_back(); //Remove outdated outlier value
 
-        if(pointcloud.leftBearing > 0.05 || pointcloud.leftBearing < -0.05)
+        if(obstacleOutput.leftBearing > 0.05 || obstacleOutput.leftBearing < -0.05)
             outliers.push_front(true);//if an obstacle is detected in front
         else 
             outliers.push_front(false); //obstacle is not detected
@@ -166,27 +331,42 @@ int main() {
             cout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!Distance Sent: " << obstacleMessage.distance << "\n";
         #endif
 
-        #if PERCEPTION_DEBUG
-        //Update Processed 3D Viewer
-        pointcloud.updateViewer(newView);
-        #if PERCEPTION_DEBUG
-            cout<<"Downsampled W: " <<pointcloud.pt_cloud_ptr->width<<" Downsampled H: "<<pointcloud.pt_cloud_ptr->height<<endl;
-        #endif
-        #endif
-        
-        #endif
-        
         /* --- Publish LCMs --- */
-        lcm_.publish("/target_list", &arTagsMessage);
         lcm_.publish("/obstacle", &obstacleMessage);
+        telemetry()[Stage::ObstacleFrameAge].record(chrono::steady_clock::now() - frame->grabTime);
+    }
+  });
+  #endif
 
-        #if !ZED_SDK_PRESENT
-            std::this_thread::sleep_for(0.2s); // Iteration speed control not needed when using camera 
-        #endif
-        
-        ++iterations;
+  /* --- Debug Display --- */
+  //Shows the AR stage's frames until it finishes, on the main thread where HighGUI is safe
+  #if PERCEPTION_DEBUG && AR_DETECTION
+  {
+    namedWindow("depth", 2);
+    shared_ptr<Frame> frame;
+    while (displayQueue.pop(frame)) {
+        imshow("depth", frame->rgb);
+        waitKey(1);
+    }
   }
+  #endif
 
+    captureThread.join();
+    arThread.join();
+    #if OBSTACLE_DETECTION
+    obstacleThread.join();
+    #endif
+    telemetryThread.join();
+    lcmThread.join();
+
+    #if PERCEPTION_DEBUG
+        cout << "Frames dropped by AR: " << arQueue.dropped() << " by obstacle: " << obstacleQueue.dropped() << endl;
+        cout << "Frames dropped by recorder: " << recorder.dropped() << endl;
+        const TrackingStats &tracking = detector.stats();
+        cout << "AR roi scans: " << tracking.roiScans << " hits: " << tracking.roiHits
+             << " misses: " << tracking.roiMisses << " pyramid scans: " << tracking.pyramidScans
+             << " full scans: " << tracking.fullScans << endl;
+    #endif
 
     /* --- Wrap Things Up --- */
     #if AR_RECORD
@@ -195,4 +375,3 @@ int main() {
   
     return 0;
 }
-
@@ -7,516 +7,383 @@
     PCL::PCL(const rapidjson::Document &mRoverConfig) : 
 
         //Populate Constants from Config File
-        MAX_FIELD_OF_VIEW_ANGLE{mRoverConfig["pt_cloud"]["max_field_of_view_angle"].GetInt()},
         PT_CLOUD_WIDTH{mRoverConfig["pt_cloud"]["pt_cloud_width"].GetInt()},
         PT_CLOUD_HEIGHT{mRoverConfig["pt_cloud"]["pt_cloud_height"].GetInt()},
-        HALF_ROVER{mRoverConfig["pt_cloud"]["half_rover"].GetInt()},
-        UP_BD_Z{mRoverConfig["pt_cloud"]["pass_through"]["upper_bd_z"].GetDouble()},
-        UP_BD_Y{mRoverConfig["pt_cloud"]["pass_through"]["upper_bd_y"].GetDouble()},
-        LOW_BD{mRoverConfig["pt_cloud"]["pass_through"]["lower_bd"].GetDouble()},
-        ROVER_W_MM{mRoverConfig["pt_cloud"]["rover_w_mm"].GetDouble()},
-        LEAF_SIZE{mRoverConfig["pt_cloud"]["downsample_voxel_filter"].GetFloat()},
-        MAX_ITERATIONS{mRoverConfig["pt_cloud"]["ransac"]["max_iterations"].GetInt()},
-        SEGMENTATION_EPSLION{mRoverConfig["pt_cloud"]["ransac"]["segmentation_epsilon"].GetDouble()},
-        DISTANCE_THRESHOLD{mRoverConfig["pt_cloud"]["ransac"]["distance_threshold"].GetDouble()},
-        CLUSTER_TOLERANCE{mRoverConfig["pt_cloud"]["euclidean_cluster"]["cluster_tolerance"].GetInt()},
-        MIN_CLUSTER_SIZE{mRoverConfig["pt_cloud"]["euclidean_cluster"]["min_cluster_size"].GetInt()},
-        MAX_CLUSTER_SIZE{mRoverConfig["pt_cloud"]["euclidean_cluster"]["max_cluster_size"].GetInt()},
         
         //Other Values
         leftBearing{0}, rightBearing{0}, distance{0}, detected{false},
-        pt_cloud_ptr{new pcl::PointCloud<pcl::PointXYZRGB>} {
-
-        #if PERCEPTION_DEBUG
-        viewer = createRGBVisualizer(); //This is a smart pointer so no need to worry ab deleteing it
-        viewer_original = createRGBVisualizer();
-        #endif
-
-        #if ZED_SDK_PRESENT
-           sl::Resolution cloud_res = sl::Resolution(PT_CLOUD_WIDTH, PT_CLOUD_HEIGHT);
-           cloudArea = cloud_res.area();
-        #else
-            cloudArea = PT_CLOUD_WIDTH*PT_CLOUD_HEIGHT;
-        #endif
+        input{nullptr},
+        clusterExtractor{0, 0, 0}, //parameters set by configure
+        groundPlane{Eigen::Vector4f::Zero()}, hasGroundPlane{false}, groundInlierRatio{0},
+        framesSinceRansac{0}, warmStartFrames{0}, ransacFrames{0} {
 
+        configure(mRoverConfig);
     };
 
-/* --- Pass Through Filter --- */
-//Filters out all points on a given axis passed as a string ("x", "y", or "z") that aren't within the threshold
-//The threshold covers points from 0.0 to upperLimit
-//Values are depth values in mm
-//Source: https://rb.gy/kkyi80
-void PCL::PassThroughFilter(const std::string axis, const double upperLimit) {
-    #if PERCEPTION_DEBUG
-        pcl::ScopeTime t("PassThroughFilter");
-    #endif
-
-    pcl::PassThrough<pcl::PointXYZRGB> pass;
-    pass.setInputCloud(pt_cloud_ptr);
-
-    pass.setFilterFieldName(axis);
-    pass.setFilterLimits( LOW_BD, upperLimit);
-    pass.filter(*pt_cloud_ptr);
+void PCL::configure(const rapidjson::Document &mRoverConfig) {
+    MAX_FIELD_OF_VIEW_ANGLE = mRoverConfig["pt_cloud"]["max_field_of_view_angle"].GetInt();
+    HALF_ROVER = mRoverConfig["pt_cloud"]["half_rover"].GetInt();
+    BEARING_BIN_SIZE = mRoverConfig["pt_cloud"]["bearing_bin_size"].GetDouble();
+    LEAF_SIZE = mRoverConfig["pt_cloud"]["downsample_voxel_filter"].GetFloat();
+    MAX_ITERATIONS = mRoverConfig["pt_cloud"]["ransac"]["max_iterations"].GetInt();
+    SEGMENTATION_EPSLION = mRoverConfig["pt_cloud"]["ransac"]["segmentation_epsilon"].GetDouble();
+    DISTANCE_THRESHOLD = mRoverConfig["pt_cloud"]["ransac"]["distance_threshold"].GetDouble();
+    WARM_START_INLIER_FRACTION = mRoverConfig["pt_cloud"]["ransac"]["warm_start_inlier_fraction"].GetDouble();
+    WARM_START_REFRESH_INTERVAL = mRoverConfig["pt_cloud"]["ransac"]["warm_start_refresh_interval"].GetInt();
+    CLUSTER_TOLERANCE = mRoverConfig["pt_cloud"]["euclidean_cluster"]["cluster_tolerance"].GetInt();
+    MIN_CLUSTER_SIZE = mRoverConfig["pt_cloud"]["euclidean_cluster"]["min_cluster_size"].GetInt();
+    MAX_CLUSTER_SIZE = mRoverConfig["pt_cloud"]["euclidean_cluster"]["max_cluster_size"].GetInt();
+
+    clusterExtractor.setParameters((float)CLUSTER_TOLERANCE, MIN_CLUSTER_SIZE, MAX_CLUSTER_SIZE);
+
+    //One extra slot so the difference array can close the last bin
+    blockedBins.resize((int)std::ceil(2 * MAX_FIELD_OF_VIEW_ANGLE / BEARING_BIN_SIZE) + 1);
+
+    //The RANSAC thresholds may have changed, so don't trust last frame's plane
+    hasGroundPlane = false;
 }
 
 /* --- Voxel Filter --- */
 //Creates clusters given by the size of a leaf
 //All points in a cluster are then reduced to a single point
 //This point is the centroid of the cluster
+//Reads the input cloud and fills the working cloud
+//Same approach as pcl::VoxelGrid: sort points by voxel, then average each run
 //Source: https://rb.gy/2ybg8n
 void PCL::DownsampleVoxelFilter() {
+    LatencyProbe probe(Stage::VoxelFilter);
     #if PERCEPTION_DEBUG
         pcl::ScopeTime t("VoxelFilter");
     #endif
 
-    pcl::VoxelGrid<pcl::PointXYZRGB> sor;
-    sor.setInputCloud (pt_cloud_ptr);
-    sor.setLeafSize(LEAF_SIZE, LEAF_SIZE, LEAF_SIZE);
-    sor.filter (*pt_cloud_ptr);
+    const CompactCloud &in = *input;
+    const float invLeaf = 1.0f / LEAF_SIZE;
+    const int numPoints = (int)in.size();
+
+    //Coordinates are int16, so voxel indices fit in 16 bits each
+    voxels.resize(numPoints);
+    for (int i = 0; i < numPoints; ++i) {
+        uint64_t vx = (uint16_t)(int16_t)std::floor(in.x[i] * invLeaf);
+        uint64_t vy = (uint16_t)(int16_t)std::floor(in.y[i] * invLeaf);
+        uint64_t vz = (uint16_t)(int16_t)std::floor(in.z[i] * invLeaf);
+        voxels[i].first = vx << 32 | vy << 16 | vz;
+        voxels[i].second = i;
+    }
+    std::sort(voxels.begin(), voxels.end());
+
+    cloud.clear();
+    for (int begin = 0; begin < numPoints;) {
+        long sumX = 0, sumY = 0, sumZ = 0;
+        int end = begin;
+        for (; end < numPoints && voxels[end].first == voxels[begin].first; ++end) {
+            int index = voxels[end].second;
+            sumX += in.x[index];
+            sumY += in.y[index];
+            sumZ += in.z[index];
+        }
+        float count = end - begin;
+        cloud.push_back(toCompact(sumX / count), toCompact(sumY / count), toCompact(sumZ / count));
+        begin = end;
+    }
 }
 
-/* --- RANSAC Plane Segmentation Blue --- */
+/* --- RANSAC Plane Segmentation --- */
 //Picks three random points in point cloud
 //Counts how many points lie on or near the plane made by these three
 //If the number of points in the plane (score) is greater than
 //some threshold then a valid plane has been found
-//Colors all points in this plane blue or
-//removes points completely from point cloud
+//The ground barely moves between frames, so last frame's plane is tried
+//first and full RANSAC only runs when it stops fitting
+//Removes points in this plane completely from point cloud
 //Source: https://rb.gy/zx6ojh
-void PCL::RANSACSegmentation(string type) {
+void PCL::RANSACSegmentation() {
+    LatencyProbe probe(Stage::GroundPlane);
     #if PERCEPTION_DEBUG
         pcl::ScopeTime t("RANSACSegmentation");
     #endif
 
-    //Creates instance of RANSAC Algorithm
-    pcl::SACSegmentation<pcl::PointXYZRGB> seg;
-    seg.setOptimizeCoefficients(true);
-    seg.setModelType(pcl::SACMODEL_PERPENDICULAR_PLANE);
-    seg.setMethodType(pcl::SAC_RANSAC);
-    seg.setMaxIterations(MAX_ITERATIONS);
-    seg.setDistanceThreshold(DISTANCE_THRESHOLD); //Distance in mm away from actual plane a point can be
-    // to be considered an inlier
-    seg.setAxis(Eigen::Vector3f(0, 1, 0)); //Looks for a plane along the Z axis
-    //Max degree the normal of plane can be from Z axis
-    seg.setEpsAngle(pcl::deg2rad(SEGMENTATION_EPSLION));
-
-    //Objects where segmented plane is stored
-    pcl::ModelCoefficients::Ptr coefficients(new pcl::ModelCoefficients());
-    pcl::PointIndices::Ptr inliers(new pcl::PointIndices());
-
-    seg.setInputCloud(pt_cloud_ptr);
-    seg.segment(*inliers, *coefficients);
-
-    if(type == "blue") {
-        for (int i = 0; i < (int)inliers->indices.size(); i++) {
-            pt_cloud_ptr->points[inliers->indices[i]].r = 255;
-            pt_cloud_ptr->points[inliers->indices[i]].g = 255;
-            pt_cloud_ptr->points[inliers->indices[i]].b = 0;
-        }
-    }
-    else {
-        //Creates object that filters out identified points
-        pcl::ExtractIndices<pcl::PointXYZRGB> extract;
-        extract.setInputCloud(pt_cloud_ptr);
-        extract.setIndices(inliers);
-        extract.setNegative(true); //Controls whether chosen indices are retained or removed
-        extract.filter(*pt_cloud_ptr);
+    if(!WarmStartGroundPlane(groundInliers)) {
+        FullRANSACGroundPlane(groundInliers);
     }
-}
 
-/* --- Euclidian Cluster Extraction --- */
-//Creates a KdTree structure from point cloud
-//Use this tree to traverse point cloud and create vector of clusters
-//Return vector of clusters
-//Source: https://rb.gy/qvjati
-void PCL::CPUEuclidianClusterExtraction(std::vector<pcl::PointIndices> &cluster_indices) {
     #if PERCEPTION_DEBUG
-        pcl::ScopeTime t("CPU Cluster Extraction");
+        std::cout << "Ground plane: " << groundPlane.transpose() << " warm starts: " << warmStartFrames
+                  << " full RANSAC: " << ransacFrames << std::endl;
     #endif
 
-    // Creating the KdTree object for the search method of the extraction
-    pcl::search::KdTree<pcl::PointXYZRGB>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZRGB>);
-    tree->setInputCloud(pt_cloud_ptr);
-
-    //Extracts clusters using nearet neighbors search
-    pcl::EuclideanClusterExtraction<pcl::PointXYZRGB> ec;
-    ec.setClusterTolerance (CLUSTER_TOLERANCE); // 60 mm radius per point
-    ec.setMinClusterSize (MIN_CLUSTER_SIZE);
-    ec.setMaxClusterSize (MAX_CLUSTER_SIZE);
-    ec.setSearchMethod (tree);
-    ec.setInputCloud (pt_cloud_ptr);
-    ec.extract (cluster_indices);
-
-    //Colors all clusters
-    #if PERCEPTION_DEBUG
-        std::cout << "Number of clusters: " << cluster_indices.size() << std::endl;
-        int j = 0;
-
-        for(std::vector<pcl::PointIndices>::const_iterator it = cluster_indices.begin(); it != cluster_indices.end(); ++it) {
-            for(std::vector<int>::const_iterator pit = it->indices.begin(); pit != it->indices.end(); ++pit) {
-                if(j % 3) {
-                    pt_cloud_ptr->points[*pit].r = 100 + j * 15;
-                    pt_cloud_ptr->points[*pit].g = 0;
-                    pt_cloud_ptr->points[*pit].b = 0;
-                }
-                else if(j % 2) {
-                    pt_cloud_ptr->points[*pit].r = 0;
-                    pt_cloud_ptr->points[*pit].g = 100 + j * 15;
-                    pt_cloud_ptr->points[*pit].b = 0;
-                }
-                else {
-                    pt_cloud_ptr->points[*pit].r = 0;
-                    pt_cloud_ptr->points[*pit].g = 0;
-                    pt_cloud_ptr->points[*pit].b = 100 + j * 15;
-                }
-            }
-            j++;
-        }
-    #endif
+    //Filters out identified points
+    RemoveIndices(groundInliers.indices);
 }
 
-/* --- Find Interest Points --- */
-//Finds the edges of each cluster by comparing x and y
-//values of all points in the cluster to find desired ones
-//Interest points are a collection of points that allow us
-//to define the edges of an obsacle
-void PCL::FindInterestPoints(std::vector<pcl::PointIndices> &cluster_indices,
-                             std::vector<std::vector<int>> &interest_points) {
-
-    #if PERCEPTION_DEBUG
-        pcl::ScopeTime t("Find Interest Points");
-    #endif
-
-    for (int i = 0; i < (int)cluster_indices.size(); ++i)
-    {
-        std::vector<int>* curr_cluster = &interest_points[i];
-        
-        //Initialize interest points
-        std::fill(curr_cluster->begin(), curr_cluster->end(), cluster_indices[i].indices[0]);
-
-        //Interest Points: 0=Leftmost Point 1=Rightmost Point 2=Lowest Point 3=Highest Point 4=Closest Point 5=Furthest Point.
-        for (auto index : cluster_indices[i].indices)
-        {
-            auto curr_point = pt_cloud_ptr->points[index];
-            
-            if(curr_point.x < pt_cloud_ptr->points[curr_cluster->at(0)].x){
-                curr_cluster->at(0) = index;
-            }
-            if(curr_point.x > pt_cloud_ptr->points[curr_cluster->at(1)].x){
-                curr_cluster->at(1) = index;
-            }
-            if(curr_point.y < pt_cloud_ptr->points[curr_cluster->at(2)].y){
-                curr_cluster->at(2) = index;
-            }
-            if(curr_point.y > pt_cloud_ptr->points[curr_cluster->at(3)].y){
-                curr_cluster->at(3) = index;
-            }
-            if(curr_point.z < pt_cloud_ptr->points[curr_cluster->at(4)].z){
-                curr_cluster->at(4) = index;
-            }
-            if(curr_point.z > pt_cloud_ptr->points[curr_cluster->at(5)].z){
-                curr_cluster->at(5) = index;
-            }
+/* --- Remove Indices --- */
+//Same as pcl::ExtractIndices with setNegative(true), but compacts the
+//working cloud in place instead of copying into a new one
+//indices must be sorted ascending, which both ground plane paths produce
+void PCL::RemoveIndices(const std::vector<int> &indices) {
+    size_t kept = 0;
+    size_t next = 0;
+    for (size_t i = 0; i < cloud.size(); ++i) {
+        if (next < indices.size() && (size_t)indices[next] == i) {
+            ++next;
+            continue;
         }
-
-        //Calulates the width of the obstacle based on the difference between the leftmost and rightmost interest point.
-        double width = std::abs(pt_cloud_ptr->points[curr_cluster->at(1)].x - pt_cloud_ptr->points[curr_cluster->at(0)].x);
-        //Calculates the number of rover widths that fit within the obstacle. The x10 multiplier adds more width increments.
-        int roverWidths = ((int) width/ROVER_W_MM) * 10;
-
-        //Only want to add interest points if the obstacle's width > rover's Width.
-        if(roverWidths > 0) {
-            //Create a map data structure where the Key is an int from 0  to roverWidths-1.
-            //Each key index represents the a percentile increment.
-            //Example: if roverWidths = 40, then index 0 would represent leftmost + 0.025 * obstacle width,
-            //index 1 would represent leftmost + 0.05 * obstacle width and so on.
-            std::map<int, double> increments;
-            for(size_t i = 0; i < (size_t) roverWidths; ++i) {
-                //The defualt value stored in each key is the value of the leftmost interest point.
-                increments[i] = pt_cloud_ptr->points[curr_cluster->at(0)].x;
-                //Creates a new interest point and sets it equal to the index of the leftmost point.
-                curr_cluster->push_back(curr_cluster->at(0));
-            }
-            
-            //Using the x value of the current point, calculate the percentile that the current point would fall under, 
-            //and then compare that x value to the one of the point that is currently representing that percentile.
-            for (auto index : cluster_indices[i].indices) {
-                auto curr_point = pt_cloud_ptr->points[index];
-                if(curr_point.x > pt_cloud_ptr->points[curr_cluster->at(0)].x && curr_point.x < pt_cloud_ptr->points[curr_cluster->at(1)].x) {
-                    //If roverWidths = 40 and if your x value falls between leftmost + 0.025 * obstacle width and leftmost + 0.05 * obstacle width,
-                    //then the value of i would be 1 which represents the index of increment map the we want to check.
-                    int j = ((double)(std::abs(curr_point.x - pt_cloud_ptr->points[curr_cluster->at(0)].x)/width)/((double) 1/roverWidths));
-                    //If the x value of the current point is greater than the value representing that percentile, 
-                    //we set the value represnting the percentile equal to the x value of the current point.
-                    if(increments[j] < curr_point.x) {
-                        increments[j] = curr_point.x;
-                        curr_cluster->at(6 + j) = index;
-                    }
-                }
-            }
-        }
-        
-        #if PERCEPTION_DEBUG
-            for(auto interest_point : *curr_cluster)
-            {
-                pt_cloud_ptr->points[interest_point].r = 255;
-                pt_cloud_ptr->points[interest_point].g = 255;
-                pt_cloud_ptr->points[interest_point].b = 255;
-            }
-        #endif
+        cloud.move(kept++, i);
     }
+    cloud.resize(kept);
 }
 
-/* --- Get Angle Off Center--- */
-//This function finds the angle off center the
-//line that passes through both these points is
-//Direction of 0 is left and 1 is right
-double PCL::getAngleOffCenter(int buffer, int direction, const std::vector<std::vector<int>> &interest_points,
-                              std::vector<int> &obstacles) {
-    double newAngle = 0;
-    //If Center Path is blocked check the left or right path depending on direction parameter
-    while (newAngle > -MAX_FIELD_OF_VIEW_ANGLE && newAngle < MAX_FIELD_OF_VIEW_ANGLE) {
-
-        //Finding angle off center
-        double oppSideRTri = pt_cloud_ptr->points[obstacles.at(direction)].x;
-        double adjSideRTri = pt_cloud_ptr->points[obstacles.at(0)].z;            //Length of adjacent side of right triangle
-        oppSideRTri += direction ? buffer + HALF_ROVER : -(buffer + HALF_ROVER); //Calculate length of opposite side of right triangle
-        newAngle = atan(oppSideRTri / adjSideRTri) * 180 / PI;                   //arctan(opposite/adjacent)
-
-        //Create compareLine Functors
-        compareLine leftLine(newAngle, -HALF_ROVER);
-        compareLine rightLine(newAngle, HALF_ROVER);
-
-        obstacles.clear();
-
-        if(CheckPath(interest_points, obstacles, leftLine, rightLine)) {
-            #if PERCEPTION_DEBUG
-                std::cout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!FOUND NEW PATH AT: " << newAngle << std::endl;
-            #endif
-            return newAngle;
+/* --- Select Inliers --- */
+void PCL::SelectInliers(const Eigen::Vector4f &plane, std::vector<int> &inliers) {
+    const float a = plane[0], b = plane[1], c = plane[2], d = plane[3];
+    const float threshold = DISTANCE_THRESHOLD;
+    inliers.clear();
+    for (int i = 0; i < (int)cloud.size(); ++i) {
+        if(std::fabs(a * cloud.x[i] + b * cloud.y[i] + c * cloud.z[i] + d) <= threshold) {
+            inliers.push_back(i);
         }
     }
-    return direction ? MAX_FIELD_OF_VIEW_ANGLE : -MAX_FIELD_OF_VIEW_ANGLE; //If couldn't find clear path
 }
 
-/* --- Find Clear Path --- */
-// Calculates left and right bearings
-void PCL::FindClearPath(const std::vector<std::vector<int>> &interest_points) {
-    #if PERCEPTION_DEBUG
-        pcl::ScopeTime t("Find Clear Path");
-    #endif
+/* --- Fit Plane --- */
+//The normal is the eigenvector of the smallest eigenvalue of the covariance
+//Sums are kept in double since coordinates reach thousands of mm
+bool PCL::FitPlane(const std::vector<int> &indices, Eigen::Vector4f &plane) {
+    if(indices.size() < 3) return false;
+
+    double sum[3] = {0, 0, 0};
+    double products[6] = {0, 0, 0, 0, 0, 0}; //xx xy xz yy yz zz
+    for(int i : indices) {
+        double x = cloud.x[i], y = cloud.y[i], z = cloud.z[i];
+        sum[0] += x; sum[1] += y; sum[2] += z;
+        products[0] += x * x; products[1] += x * y; products[2] += x * z;
+        products[3] += y * y; products[4] += y * z; products[5] += z * z;
+    }
 
-    std::vector<int> obstacles; //index of the leftmost and rightmost obstacles in path
+    double n = indices.size();
+    Eigen::Vector3f centroid(sum[0] / n, sum[1] / n, sum[2] / n);
+    Eigen::Matrix3f covariance;
+    covariance(0, 0) = products[0] / n - centroid[0] * (double)centroid[0];
+    covariance(0, 1) = products[1] / n - centroid[0] * (double)centroid[1];
+    covariance(0, 2) = products[2] / n - centroid[0] * (double)centroid[2];
+    covariance(1, 1) = products[3] / n - centroid[1] * (double)centroid[1];
+    covariance(1, 2) = products[4] / n - centroid[1] * (double)centroid[2];
+    covariance(2, 2) = products[5] / n - centroid[2] * (double)centroid[2];
+    covariance(1, 0) = covariance(0, 1);
+    covariance(2, 0) = covariance(0, 2);
+    covariance(2, 1) = covariance(1, 2);
+
+    float eigenValue;
+    Eigen::Vector3f normal;
+    pcl::eigen33(covariance, eigenValue, normal);
+    plane << normal, -normal.dot(centroid);
+    return true;
+}
 
-    //Check Center Path
-    if(CheckPath(interest_points, obstacles, compareLine(0,-HALF_ROVER), compareLine(0,HALF_ROVER))) {
-      leftBearing = 0; // When no obstacles detected, reset bearings
-      rightBearing = 0;
-      #if PERCEPTION_DEBUG
-            std::cout << "CENTER PATH IS CLEAR!!!" << std::endl;
-      #endif
+/* --- Warm Start Ground Plane --- */
+//Collects the points within DISTANCE_THRESHOLD of last frame's plane
+//If enough of the cloud still lies on it, the plane is refit to those
+//points with least squares and RANSAC is skipped for this frame
+bool PCL::WarmStartGroundPlane(pcl::PointIndices &inliers) {
+    if(!hasGroundPlane || framesSinceRansac >= WARM_START_REFRESH_INTERVAL || cloud.empty()) {
+        return false;
     }
-    
-    else {
 
-        //Values that store the distances of the last obstacle from a given CheckPath. Center value gets its distance from previous loop of CheckPath
-        double centerDistance = distance, leftDistance, rightDistance;
+    SelectInliers(groundPlane, inliers.indices);
 
-        //Initialize base cases outside of scope
-        vector<int> centerObstacles = {obstacles.at(0), obstacles.at(1)};
+    //Ground has dropped out of view or the rover has pitched onto a new slope
+    double ratio = (double)inliers.indices.size() / cloud.size();
+    if(ratio < WARM_START_INLIER_FRACTION * groundInlierRatio) {
+        return false;
+    }
 
-        //Find clear left path, set left bearing
-        leftBearing = getAngleOffCenter(10, 0, interest_points, obstacles);
-        leftDistance = distance; 
+    //Refit so the plane follows the ground as the rover drives
+    Eigen::Vector4f plane;
+    if(!FitPlane(inliers.indices, plane)) {
+        return false;
+    }
 
-        //Reset global variables
-        obstacles = {0, 0};
-        obstacles.at(0) = centerObstacles.at(0);
-        obstacles.at(1) = centerObstacles.at(1);
+    //Keep the normal pointing the same way and inside the allowed angle from the Y axis
+    if(plane[1] * groundPlane[1] < 0) plane = -plane;
+    if(std::fabs(plane[1]) < std::cos(pcl::deg2rad(SEGMENTATION_EPSLION))) {
+        return false;
+    }
+    groundPlane = plane;
 
-        //Find clear right path, set right bearing
-        rightBearing = getAngleOffCenter(10, 1, interest_points, obstacles);
-        rightDistance = distance;
+    ++framesSinceRansac;
+    ++warmStartFrames;
+    return true;
+}
 
-        //return smallest distance of an obstacle from all the paths
-        if(rightDistance < leftDistance && rightDistance < centerDistance) distance = rightDistance/1000.0;
-        else if(leftDistance < rightDistance && leftDistance < centerDistance) distance = leftDistance/1000.0;
-        else distance = centerDistance/1000.0;
+/* --- Full RANSAC Ground Plane --- */
+//Runs RANSAC from a cold start and remembers the plane for next frame
+//Same model as pcl::SACMODEL_PERPENDICULAR_PLANE with optimized coefficients:
+//planes whose normal is more than SEGMENTATION_EPSLION degrees off the Y axis
+//are rejected, and the best plane is refit to its inliers with least squares
+void PCL::FullRANSACGroundPlane(pcl::PointIndices &inliers) {
+    inliers.indices.clear();
+    hasGroundPlane = false;
+    const int numPoints = (int)cloud.size();
+    const float minNormalY = std::cos(pcl::deg2rad(SEGMENTATION_EPSLION));
+    std::uniform_int_distribution<int> pick(0, std::max(0, numPoints - 1));
+
+    Eigen::Vector4f best = Eigen::Vector4f::Zero();
+    for(int iteration = 0; numPoints >= 3 && iteration < MAX_ITERATIONS; ++iteration) {
+        int i = pick(rng), j = pick(rng), k = pick(rng);
+        Eigen::Vector3f p0(cloud.x[i], cloud.y[i], cloud.z[i]);
+        Eigen::Vector3f p1(cloud.x[j], cloud.y[j], cloud.z[j]);
+        Eigen::Vector3f p2(cloud.x[k], cloud.y[k], cloud.z[k]);
+
+        //Repeated or collinear samples don't define a plane
+        Eigen::Vector3f normal = (p1 - p0).cross(p2 - p0);
+        float length = normal.norm();
+        if(length < 1e-3f) continue;
+        normal /= length;
+        if(std::fabs(normal[1]) < minNormalY) continue;
+
+        Eigen::Vector4f plane;
+        plane << normal, -normal.dot(p0);
+        SelectInliers(plane, candidateInliers.indices);
+        if(candidateInliers.indices.size() > inliers.indices.size()) {
+            std::swap(inliers.indices, candidateInliers.indices);
+            best = plane;
+        }
     }
+
+    if(FitPlane(inliers.indices, groundPlane)) {
+        //Refitting can tilt the plane past the limit, fall back to the sampled one
+        if(std::fabs(groundPlane[1]) < minNormalY) groundPlane = best;
+        SelectInliers(groundPlane, inliers.indices);
+        hasGroundPlane = !inliers.indices.empty();
+        groundInlierRatio = (double)inliers.indices.size() / numPoints;
+    }
+
+    framesSinceRansac = 0;
+    ++ransacFrames;
 }
 
-/* --- Check Path --- */
-//Returns T or F based on whether or not the input path is obstructed
-//If it is obstructed returns false
-//The path is constructed using the left x value and right x value of
-//the furthest points on the path
-bool PCL::CheckPath(const std::vector<std::vector<int>> &interest_points,
-                    std::vector<int> &obstacles, compareLine leftLine, compareLine rightLine) {
+/* --- Euclidian Cluster Extraction --- */
+//Buckets the point cloud into cells one cluster tolerance wide
+//Joins neighboring points within tolerance to create vector of clusters
+//Return vector of clusters, same as pcl::EuclideanClusterExtraction
+//Source: https://rb.gy/qvjati
+void PCL::CPUEuclidianClusterExtraction(std::vector<pcl::PointIndices> &cluster_indices) {
+    LatencyProbe probe(Stage::Clustering);
     #if PERCEPTION_DEBUG
-        pcl::ScopeTime t("Check Path");
+        pcl::ScopeTime t("CPU Cluster Extraction");
     #endif
 
-    bool end = true; 
-    double previousDistance = -1;
-
-    //if there are no interest points, the distance from the last obstacle should be -1
-    distance = previousDistance;
-    
-    //Iterate through interest points
-    for(auto cluster : interest_points) {
-        double sizeOfCluster = 0;
-        double currentDistance = 0;
-        for (auto index : cluster) {
-            //Check if the obstacle interest point is to the right of the left projected path of the rover 
-            //and to the left of the right projected path of the rover
-            if(leftLine(pt_cloud_ptr->points[index].x, pt_cloud_ptr->points[index].z) >= 0 &&
-                rightLine(pt_cloud_ptr->points[index].x, pt_cloud_ptr->points[index].z) <= 0) {
-                end = false;
-
-                //Check if obstacles is initialized
-                if(obstacles.size() == 0) {
-                    obstacles.push_back(index);
-                    obstacles.push_back(index);
-                }
-                //Check if leftmost interest point in rover path
-                else if(pt_cloud_ptr->points[index].x < pt_cloud_ptr->points[obstacles.at(0)].x) {
-                    obstacles.at(0) = index;
-                }
-                //Check if rightmost interest point in rover path
-                else if(pt_cloud_ptr->points[index].x > pt_cloud_ptr->points[obstacles.at(1)].x) {
-                    obstacles.at(1) = index;
-                }
-
-                #if PERCEPTION_DEBUG
-                    //Make interest points orange if they are within rover path
-                    pt_cloud_ptr->points[index].r = 255;
-                    pt_cloud_ptr->points[index].g = 69;
-                    pt_cloud_ptr->points[index].b = 0;
-                #endif
-
-                //adds distance from a point in a cluster to currentDistance, and keeps track of the cluster size
-                currentDistance += pt_cloud_ptr->points[index].z;
-                sizeOfCluster++; 
-            }
-        }
-        //to find the distance from an obstacle detected, add up all the z values from a given cluster of points
-        //then divide by the number of points in the cluster
-        currentDistance = 1.0 * currentDistance / sizeOfCluster;
-
-        //if the last obstacle distance from a CheckPath loop was smaller, keep the smaller value, otherwise keep the current distance value
-        if(currentDistance < previousDistance || (previousDistance == -1 && sizeOfCluster != 0)) {
-            previousDistance = currentDistance;
-            distance = previousDistance;
-        }
-    }
+    //Extracts clusters using a sorted voxel grid neighbor search, 60 mm radius per point
+    clusterExtractor.extract(cloud, cluster_indices);
 
     #if PERCEPTION_DEBUG
-        //Project path in viewer
-        pcl::PointXYZRGB pt1;
-        pt1.x = leftLine.xIntercept;
-        pt1.y = 0;
-        pt1.z = 0;
-        pcl::PointXYZRGB pt2;
-        pt2.x = rightLine.xIntercept;
-        pt2.y = 0;
-        pt2.z = 0;
-        pcl::PointXYZRGB pt3(pt1);
-        pt3.z = 7000;
-        pt3.x = leftLine.xIntercept;
-
-        if(leftLine.slope != 0) { //Don't want to divide by 0
-            pt3.x = pt3.z / leftLine.slope + leftLine.xIntercept;
-        }
+        std::cout << "Number of clusters: " << cluster_indices.size() << std::endl;
+    #endif
+}
+
+/* --- Find Clear Path --- */
+//Builds a polar histogram of which bearings are blocked in one sweep over
+//the obstacle points. The rover's corridor at bearing b covers points with
+//|x - z*tan(b)| <= HALF_ROVER, so each point blocks the contiguous range of
+//bearings from atan((x - HALF_ROVER) / z) to atan((x + HALF_ROVER) / z).
+//Left and right bearings are the closest clear bins on each side of center
+//Distance is to the nearest obstacle straight ahead, -1 if the center is clear
+void PCL::FindClearPath(const std::vector<pcl::PointIndices> &cluster_indices) {
+    LatencyProbe probe(Stage::ClearPath);
+    #if PERCEPTION_DEBUG
+        pcl::ScopeTime t("Find Clear Path");
+    #endif
 
-        pcl::PointXYZRGB pt4(pt2);
-        pt4.z = 7000;
-        pt4.x = rightLine.xIntercept;
+    const double buffer = 10; //Clearance in mm past the edge of an obstacle
+    const double halfCorridor = HALF_ROVER + buffer;
+    const int numBins = (int)blockedBins.size() - 1;
+    double centerDistance = -1;
 
-        if(rightLine.slope != 0) { //Don't want to divide by 0
-            pt4.x = pt4.z / rightLine.slope + rightLine.xIntercept;
-        }
+    std::fill(blockedBins.begin(), blockedBins.end(), 0);
 
-        if(end) {
-            viewer->removeShape("l1");
-            viewer->removeShape("l2");
-            viewer->addLine(pt1, pt3, 0, 255, 0, "l1");
-            viewer->addLine(pt2, pt4, 0, 255, 0, "l2");
-        }
-        else {
-            viewer->removeShape("l1");
-            viewer->removeShape("l2");
-            viewer->addLine(pt1, pt3, 255, 0, 0, "l1");
-            viewer->addLine(pt2, pt4, 255, 0, 0, "l2");
-        }
-    #endif
+    for(const auto &cluster : cluster_indices) {
+        //Distance to a cluster is the average depth of its points in the center path
+        double clusterDepth = 0;
+        int centerPoints = 0;
 
-    return end;
-}
+        for(int index : cluster.indices) {
+            const double x = cloud.x[index];
+            const double z = cloud.z[index];
+            if(z <= 0) continue;
 
+            if(x >= -HALF_ROVER && x <= HALF_ROVER) {
+                clusterDepth += z;
+                ++centerPoints;
+            }
+
+            //Range of bearings this point blocks
+            double low = atan((x - halfCorridor) / z) * 180 / PI + MAX_FIELD_OF_VIEW_ANGLE;
+            double high = atan((x + halfCorridor) / z) * 180 / PI + MAX_FIELD_OF_VIEW_ANGLE;
+            if(high < 0 || low >= 2 * MAX_FIELD_OF_VIEW_ANGLE) continue;
+
+            int lowBin = std::max(0, (int)(low / BEARING_BIN_SIZE));
+            int highBin = std::min(numBins - 1, (int)(high / BEARING_BIN_SIZE));
+            ++blockedBins[lowBin];
+            --blockedBins[highBin + 1];
+        }
+
+        if(centerPoints && (centerDistance < 0 || clusterDepth / centerPoints < centerDistance)) {
+            centerDistance = clusterDepth / centerPoints;
+        }
+    }
 
-void PCL::updateViewer(bool is_original) {
-    if(is_original) {
-        viewer_original->updatePointCloud(pt_cloud_ptr);
-        viewer_original->spinOnce(10);
+    for(int bin = 1; bin < numBins; ++bin) {
+        blockedBins[bin] += blockedBins[bin - 1];
     }
 
+    //Check Center Path
+    if(centerDistance < 0) {
+        leftBearing = 0; // When no obstacles detected, reset bearings
+        rightBearing = 0;
+        distance = -1;
+        #if PERCEPTION_DEBUG
+            std::cout << "CENTER PATH IS CLEAR!!!" << std::endl;
+        #endif
+    }
     else {
-        viewer->updatePointCloud(pt_cloud_ptr);
-        viewer->spinOnce(20);
+        //Walk outward from center, a clear bin is clear across its whole width
+        //so the edge nearest center is the smallest turn that gets around
+        int centerBin = (int)(MAX_FIELD_OF_VIEW_ANGLE / BEARING_BIN_SIZE);
+
+        leftBearing = -MAX_FIELD_OF_VIEW_ANGLE;
+        for(int bin = centerBin - 1; bin >= 0; --bin) {
+            if(!blockedBins[bin]) {
+                leftBearing = std::min(0.0, (bin + 1) * BEARING_BIN_SIZE - MAX_FIELD_OF_VIEW_ANGLE);
+                break;
+            }
+        }
+
+        rightBearing = MAX_FIELD_OF_VIEW_ANGLE;
+        for(int bin = centerBin; bin < numBins; ++bin) {
+            if(!blockedBins[bin]) {
+                rightBearing = std::max(0.0, bin * BEARING_BIN_SIZE - MAX_FIELD_OF_VIEW_ANGLE);
+                break;
+            }
+        }
+
+        distance = centerDistance / 1000.0;
+        #if PERCEPTION_DEBUG
+            std::cout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!FOUND NEW PATHS AT: " << leftBearing << ", " << rightBearing << std::endl;
+        #endif
     }
 }
-/* --- Create Visualizer --- */
-//Creates a point cloud visualizer
-shared_ptr<pcl::visualization::PCLVisualizer> PCL::createRGBVisualizer() {
-    // Open 3D viewer and add point cloud
-
-    //Creates visualizer with window if PERCEPTION_DEBUG is true, and mutes output otherwise
-    shared_ptr<pcl::visualization::PCLVisualizer> viewer(new pcl::visualization::PCLVisualizer("PCL ZED 3D Viewer", PERCEPTION_DEBUG));
-
-    viewer->setBackgroundColor(0.12, 0.12, 0.12);
-    pcl::visualization::PointCloudColorHandlerRGBField<pcl::PointXYZRGB> rgb(pt_cloud_ptr);
-    viewer->addPointCloud<pcl::PointXYZRGB>(pt_cloud_ptr, rgb);
-    viewer->setPointCloudRenderingProperties(pcl::visualization::PCL_VISUALIZER_POINT_SIZE, 1.5);
-    viewer->addCoordinateSystem(1.0);
-    viewer->initCameraParameters();
-    viewer->setCameraPosition(0, 0, -800, 0, -1, 0);
-
-    return (viewer);
-}
 
 /* --- Main --- */
 //This is the main point cloud processing function
 //It returns the bearing the rover should traverse
-//For the PassThroughFilter function we can trust the ZED depth for up to 7000 mm (7 m) for "z" axis.
-//3000 mm (3m) for "x" is a placeholder, we will chnage this value based on further testing.
+//The cloud arrives already cropped to the pass through bounds by Camera::getDataCloud,
+//we can trust the ZED depth for up to 7000 mm (7 m) on the "z" axis.
 //This function is called in main.cpp
 void PCL::pcl_obstacle_detection() {
-    obstacle_return result;
-    PassThroughFilter("z", UP_BD_Z);
-    PassThroughFilter("y", UP_BD_Y);
+    LatencyProbe probe(Stage::ObstacleDetection);
     DownsampleVoxelFilter();
-    RANSACSegmentation("remove");
-    std::vector<pcl::PointIndices> cluster_indices;
-    CPUEuclidianClusterExtraction(cluster_indices);
-    std::vector<std::vector<int>> interest_points(cluster_indices.size(), vector<int> (6));
-    FindInterestPoints(cluster_indices, interest_points);
-    FindClearPath(interest_points); 
-}
-
-
-
-/* --- Update --- */
-//Cleares and resizes cloud for new data
-void PCL::update() {
-    pt_cloud_ptr->clear();
-    pt_cloud_ptr->points.resize(cloudArea);
-    pt_cloud_ptr->width = PT_CLOUD_WIDTH;
-    pt_cloud_ptr->height = PT_CLOUD_HEIGHT;
-
-    #if PERCEPTION_DEBUG
-        std::cout << "Width: " << pt_cloud_ptr->width << std::endl;
-        std::cout << "Height: " << pt_cloud_ptr->height << "\n";
-    #endif
+    RANSACSegmentation();
+    CPUEuclidianClusterExtraction(clusterIndices);
+    FindClearPath(clusterIndices);
 }
 
 #endif
@@ -2,65 +2,20 @@
 #pragma once
 
 #include "perception.hpp"
+#include "grid_cluster.hpp"
+#include "compact_cloud.hpp"
 #include <pcl/common/common_headers.h>
 #include <float.h>
-
-/* --- Compare Line Class --- */
-/**
-\brief Functor that indicates where a point is in
-relation to a line in 2D space
-recieves angle off y axis
-*/
-class compareLine {
-public:
-    int xIntercept;
-    double slope;
-    
-    compareLine(double angle_in, int xInt_in) : xIntercept{xInt_in}, 
-                        slope{tan(angle_in*PI/180)} {
-                            if(slope != 0) {
-                                slope = 1/slope;
-                            }
-                        }
-
-    //Returns 1 if point is right of line, 0 if on, -1 if left of line
-    int operator()(int x, int y) {
-        
-        //Make sure don't divide by 0
-        double xc = xIntercept; //x calculated
-        if(slope != 0) {
-            xc = y/slope+xIntercept; //Find x value on line with same y value as input point
-        }
-            
-        //Point is right of the line
-        if(x > xc) {
-            return 1;
-        }
-        //Point is on the line
-        else if (x == xc) {
-            return 0;
-        }
-        //Point is left of the line
-        else {
-            return -1;
-        } 
-    }
-};
+#include <random>
 
 class PCL {
     public:
-        shared_ptr<pcl::visualization::PCLVisualizer> viewer;
-        shared_ptr<pcl::visualization::PCLVisualizer> viewer_original;
-
         //Constants
         int MAX_FIELD_OF_VIEW_ANGLE;
         int PT_CLOUD_WIDTH;
         int PT_CLOUD_HEIGHT;
         int HALF_ROVER;
-        double UP_BD_Z;
-        double UP_BD_Y;
-        double LOW_BD ;
-        double ROVER_W_MM;
+        double BEARING_BIN_SIZE;
         float LEAF_SIZE;
 
         //RANSAC constants
@@ -68,6 +23,10 @@ class PCL {
         double SEGMENTATION_EPSLION;
         double DISTANCE_THRESHOLD;
 
+        //Ground plane warm start constants
+        double WARM_START_INLIER_FRACTION;
+        int WARM_START_REFRESH_INTERVAL;
+
         //Euclidean cluster constants
         int CLUSTER_TOLERANCE;
         int MIN_CLUSTER_SIZE;
@@ -78,64 +37,81 @@ class PCL {
         double rightBearing;
         double distance;
         bool detected;
-        pcl::PointCloud<pcl::PointXYZRGB>::Ptr pt_cloud_ptr;
-        int cloudArea;
+        //Cloud straight from the camera, only read
+        const CompactCloud *input;
+
+        //Working cloud the stages filter into, owned by PCL so its
+        //allocation is reused every frame
+        CompactCloud cloud;
+
+        //Euclidean clustering engine, reused every frame
+        GridClusterExtraction clusterExtractor;
+
+        //Per frame results kept as members so their storage is reused
+        std::vector<std::pair<uint64_t, int>> voxels;
+        pcl::PointIndices groundInliers;
+        pcl::PointIndices candidateInliers;
+        std::vector<pcl::PointIndices> clusterIndices;
+
+        //Ground plane from the last frame as ax + by + cz + d = 0, normal is unit length
+        Eigen::Vector4f groundPlane;
+        bool hasGroundPlane;
+
+        //Fraction of points that were ground on the last full RANSAC
+        double groundInlierRatio;
+
+        //Samples points for RANSAC, default seeded so runs are repeatable
+        std::mt19937 rng;
+
+        //Number of obstacle points blocking the corridor at each bearing bin
+        //Filled as a difference array then prefix summed
+        std::vector<int> blockedBins;
+
+        //Ground plane statistics for tuning
+        int framesSinceRansac;
+        long warmStartFrames;
+        long ransacFrames;
 
         //Constructor
         PCL(const rapidjson::Document &mRoverConfig);
 
-        //Destructor for PCL
-        ~PCL() {
-        #if OBSTACLE_DETECTION && PERCEPTION_DEBUG 
-            viewer -> close();
-            viewer_original -> close();
-        #endif
-        };
+        //Reads the obstacle detection constants, call between frames to pick up a reloaded config
+        //The cloud size is fixed at construction since the capture thread reads it
+        void configure(const rapidjson::Document &mRoverConfig);
 
     private:
 
-        //Filters points with values beyond certain threshold
-        void PassThroughFilter(const std::string axis, const double upperLimit);
-        
         //Clusters nearby points to reduce total number of points
         void DownsampleVoxelFilter();
         
-        //Finds the ground plane
-        void RANSACSegmentation(string type);
+        //Finds the ground plane and removes it from the working cloud
+        void RANSACSegmentation();
+
+        //Removes the points at the sorted indices from the working cloud in place
+        void RemoveIndices(const std::vector<int> &indices);
+
+        //Tries to reuse last frame's ground plane, returns false if it no longer fits
+        bool WarmStartGroundPlane(pcl::PointIndices &inliers);
+
+        //Runs full RANSAC from scratch and stores the result for the next frame
+        void FullRANSACGroundPlane(pcl::PointIndices &inliers);
+
+        //Fills inliers with the points within DISTANCE_THRESHOLD of plane
+        void SelectInliers(const Eigen::Vector4f &plane, std::vector<int> &inliers);
+
+        //Least squares plane through the points, normal is unit length
+        //Returns false if there are too few points to fit
+        bool FitPlane(const std::vector<int> &indices, Eigen::Vector4f &plane);
         
         //Clusters nearby points into large obstacles
         void CPUEuclidianClusterExtraction(std::vector<pcl::PointIndices> &cluster_indices);
         
-        //Finds the four corners of the clustered obstacles
-        void FindInterestPoints(std::vector<pcl::PointIndices> &cluster_indices, std::vector<std::vector<int>> &interest_points);
-        
-        //Finds a clear path given the obstacle corners
-        void FindClearPath(const std::vector<std::vector<int>> &interest_points);
-
-        //Determines whether the input path is obstructed
-        bool CheckPath(const std::vector<std::vector<int>> &interest_points,
-               std::vector<int> &obstacles, compareLine leftLine, compareLine rightLine);
-        
-        /**
-        \brief Determines angle off center a clear path can be found
-        \param direction: given 0 finds left clear path given 1 find right clear path
-        */
-        double getAngleOffCenter(int buffer, int direction, const std::vector<std::vector<int>> &interest_points,
-                    std::vector<int> &obstacles);
+        //Finds a clear path and the nearest obstacle distance from the clusters
+        void FindClearPath(const std::vector<pcl::PointIndices> &cluster_indices);
 
     public:
         //Main function that runs the above 
         void pcl_obstacle_detection();
-
-        //Updates point cloud in the visualizer
-        //Note: if bool is_original is true, we are using the original viewer
-        void updateViewer(bool is_original);
-        
-        //Creates a point cloud visualizer
-        shared_ptr<pcl::visualization::PCLVisualizer> createRGBVisualizer();
-
-        //Cleares and resizes cloud for new data
-        void update();
 };
 
 #endif
@@ -0,0 +1,298 @@
+#include "percep_config.hpp"
+#include "rapidjson/error/en.h"
+#include "rapidjson/pointer.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+/* --- Config Schema --- */
+enum class ValueType {
+    Int,
+    Number,
+    String,
+    IntArray,
+    ObjectArray
+};
+
+//Values a number has to fall in, Any when every value works
+enum class Range {
+    Any,
+    Positive,
+    NonNegative,
+    Fraction
+};
+
+struct ConfigValue {
+    const char *path;
+    ValueType type;
+    Range range;
+};
+
+//Every value read from the config, as a JSON pointer
+//Ranges keep out values that would divide by zero, loop forever or size
+//buffers from nonsense, so a config that passes can't crash a stage
+static const ConfigValue SCHEMA[] = {
+    { "/mm_per_m", ValueType::Int, Range::Positive },
+
+    { "/camera/threshold_confidence", ValueType::Number },
+    { "/camera/frame_write_interval", ValueType::Int, Range::Positive },
+
+    { "/ar_tag/default_tag_val", ValueType::Int },
+    { "/ar_tag/buffer_iterations", ValueType::Int, Range::NonNegative },
+    { "/ar_tag/tracking/enabled", ValueType::Int },
+    { "/ar_tag/tracking/full_scan_interval", ValueType::Int, Range::NonNegative },
+    { "/ar_tag/tracking/roi_margin", ValueType::Number, Range::NonNegative },
+    { "/ar_tag/tracking/min_roi_margin_px", ValueType::Int, Range::NonNegative },
+
+    { "/alvar_params/marker_border_bits", ValueType::Int, Range::Positive },
+    { "/alvar_params/do_corner_refinement", ValueType::Int },
+    { "/alvar_params/polygonal_approx_accuracy_rate", ValueType::Number, Range::Positive },
+    { "/alvar_params/pyramid_scales", ValueType::IntArray },
+    { "/alvar_params/min_pyramid_tag_px", ValueType::Int, Range::Positive },
+    { "/alvar_params/full_res_scan_interval", ValueType::Int, Range::Positive },
+
+    { "/pt_cloud/max_field_of_view_angle", ValueType::Int, Range::Positive },
+    { "/pt_cloud/pt_cloud_width", ValueType::Int, Range::Positive },
+    { "/pt_cloud/pt_cloud_height", ValueType::Int, Range::Positive },
+    { "/pt_cloud/half_rover", ValueType::Int, Range::NonNegative },
+    { "/pt_cloud/bearing_bin_size", ValueType::Number, Range::Positive },
+    { "/pt_cloud/downsample_voxel_filter", ValueType::Number, Range::Positive },
+    { "/pt_cloud/pass_through/lower_bd", ValueType::Number },
+    { "/pt_cloud/pass_through/upper_bd_z", ValueType::Number },
+    { "/pt_cloud/pass_through/upper_bd_y", ValueType::Number },
+    { "/pt_cloud/ransac/max_iterations", ValueType::Int, Range::Positive },
+    { "/pt_cloud/ransac/segmentation_epsilon", ValueType::Number, Range::NonNegative },
+    { "/pt_cloud/ransac/distance_threshold", ValueType::Number, Range::Positive },
+    { "/pt_cloud/ransac/warm_start_inlier_fraction", ValueType::Number, Range::Fraction },
+    { "/pt_cloud/ransac/warm_start_refresh_interval", ValueType::Int, Range::NonNegative },
+    { "/pt_cloud/euclidean_cluster/cluster_tolerance", ValueType::Int, Range::Positive },
+    { "/pt_cloud/euclidean_cluster/min_cluster_size", ValueType::Int, Range::NonNegative },
+    { "/pt_cloud/euclidean_cluster/max_cluster_size", ValueType::Int, Range::Positive },
+
+    { "/depth_obstacle/enabled", ValueType::Int },
+    { "/depth_obstacle/camera_height_mm", ValueType::Number, Range::Positive },
+    { "/depth_obstacle/camera_tilt_deg", ValueType::Number },
+    { "/depth_obstacle/horizontal_fov_deg", ValueType::Number, Range::Positive },
+    { "/depth_obstacle/min_height_mm", ValueType::Number },
+    { "/depth_obstacle/max_height_mm", ValueType::Number },
+    { "/depth_obstacle/max_range_mm", ValueType::Number, Range::Positive },
+    { "/depth_obstacle/row_step", ValueType::Int, Range::Positive },
+    { "/depth_obstacle/min_column_points", ValueType::Int, Range::Positive },
+
+    { "/pipeline/queue_depth", ValueType::Int, Range::Positive },
+    { "/pipeline/pool_warmup_frames", ValueType::Int, Range::NonNegative },
+
+    { "/offline/loader_threads", ValueType::Int, Range::Positive },
+    { "/offline/prefetch_frames", ValueType::Int, Range::NonNegative },
+    { "/offline/cache_mb", ValueType::Int, Range::NonNegative },
+
+    { "/recorder/queue_depth", ValueType::Int, Range::Positive },
+    { "/recorder/pcd_format", ValueType::String },
+    { "/recorder/channel", ValueType::String },
+
+    { "/governor/enabled", ValueType::Int },
+    { "/governor/budget_ms", ValueType::Number, Range::Positive },
+    { "/governor/window_frames", ValueType::Int, Range::Positive },
+    { "/governor/step_down_fraction", ValueType::Number, Range::Fraction },
+    { "/governor/step_up_fraction", ValueType::Number, Range::Fraction },
+    { "/governor/step_up_windows", ValueType::Int, Range::Positive },
+    { "/governor/initial_level", ValueType::Int },
+    { "/governor/channel", ValueType::String },
+    { "/governor/levels", ValueType::ObjectArray },
+
+    { "/debug_stream/enabled", ValueType::Int },
+    { "/debug_stream/channel", ValueType::String },
+    { "/debug_stream/max_rate_hz", ValueType::Number, Range::Positive },
+    { "/debug_stream/voxel_mm", ValueType::Number, Range::Positive },
+    { "/debug_stream/quantization_mm", ValueType::Number, Range::Positive },
+
+    { "/scene/frames", ValueType::Int, Range::NonNegative },
+    { "/scene/seed", ValueType::Int },
+    { "/scene/image_width", ValueType::Int, Range::Positive },
+    { "/scene/image_height", ValueType::Int, Range::Positive },
+    { "/scene/horizontal_fov_deg", ValueType::Number, Range::Positive },
+    { "/scene/camera_height_mm", ValueType::Number },
+    { "/scene/camera_tilt_deg", ValueType::Number },
+    { "/scene/speed_mm_per_frame", ValueType::Number, Range::NonNegative },
+    { "/scene/slope_deg", ValueType::Number },
+    { "/scene/roughness_mm", ValueType::Number, Range::NonNegative },
+    { "/scene/rocks", ValueType::Int, Range::NonNegative },
+    { "/scene/rock_min_radius_mm", ValueType::Number, Range::Positive },
+    { "/scene/rock_max_radius_mm", ValueType::Number, Range::Positive },
+    { "/scene/tags", ValueType::Int, Range::NonNegative },
+    { "/scene/tag_size_mm", ValueType::Number, Range::Positive },
+    { "/scene/tag_post_height_mm", ValueType::Number, Range::Positive },
+    { "/scene/spread_mm", ValueType::Number, Range::Positive },
+    { "/scene/min_range_mm", ValueType::Number, Range::NonNegative },
+    { "/scene/max_range_mm", ValueType::Number, Range::Positive },
+    { "/scene/depth_noise_mm", ValueType::Number, Range::NonNegative },
+    { "/scene/dropout", ValueType::Number, Range::Fraction },
+
+    { "/telemetry/publish_interval_ms", ValueType::Int, Range::Positive },
+    { "/telemetry/channel", ValueType::String },
+
+    { "/config_channel", ValueType::String }
+};
+
+//Every value read from each entry of governor/levels
+static const ConfigValue GOVERNOR_LEVEL_SCHEMA[] = {
+    { "/cloud_width", ValueType::Int, Range::Positive },
+    { "/cloud_height", ValueType::Int, Range::Positive },
+    { "/leaf_size", ValueType::Number, Range::Positive },
+    { "/ransac_iterations", ValueType::Int, Range::Positive }
+};
+
+static bool hasType(const rapidjson::Value &value, ValueType type) {
+    switch (type) {
+        case ValueType::Int: return value.IsInt();
+        case ValueType::Number: return value.IsNumber();
+        case ValueType::String: return value.IsString();
+        case ValueType::IntArray:
+            if (!value.IsArray()) return false;
+            for (auto &element : value.GetArray()) {
+                if (!element.IsInt()) return false;
+            }
+            return true;
+        case ValueType::ObjectArray:
+            if (!value.IsArray() || value.Empty()) return false;
+            for (auto &element : value.GetArray()) {
+                if (!element.IsObject()) return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+static bool inRange(const rapidjson::Value &value, Range range) {
+    if (!value.IsNumber()) return true;
+    double number = value.GetDouble();
+    switch (range) {
+        case Range::Any: return true;
+        case Range::Positive: return number > 0;
+        case Range::NonNegative: return number >= 0;
+        case Range::Fraction: return number >= 0 && number <= 1;
+    }
+    return false;
+}
+
+static const char *rangeName(Range range) {
+    switch (range) {
+        case Range::Any: return "any value";
+        case Range::Positive: return "positive";
+        case Range::NonNegative: return "zero or more";
+        case Range::Fraction: return "between 0 and 1";
+    }
+    return "";
+}
+
+static const char *typeName(ValueType type) {
+    switch (type) {
+        case ValueType::Int: return "an integer";
+        case ValueType::Number: return "a number";
+        case ValueType::String: return "a string";
+        case ValueType::IntArray: return "an array of integers";
+        case ValueType::ObjectArray: return "a non-empty array of objects";
+    }
+    return "";
+}
+
+//Checks value is at path under root with the right type and in range
+static bool checkValue(const rapidjson::Value &root, const string &prefix, const ConfigValue &value, string &error) {
+    const rapidjson::Value *found = rapidjson::Pointer(value.path).Get(root);
+    if (!found) {
+        error = "missing " + prefix + value.path;
+        return false;
+    }
+    if (!hasType(*found, value.type)) {
+        error = prefix + value.path + " must be " + typeName(value.type);
+        return false;
+    }
+    if (!inRange(*found, value.range)) {
+        error = prefix + value.path + " must be " + rangeName(value.range);
+        return false;
+    }
+    return true;
+}
+
+/* --- Config Loading --- */
+bool parseConfig(const string &text, rapidjson::Document &config, string &error) {
+    rapidjson::Document parsed;
+    parsed.Parse(text.c_str());
+    if (parsed.HasParseError()) {
+        error = "json error at offset " + to_string(parsed.GetErrorOffset()) + ": " +
+                rapidjson::GetParseError_En(parsed.GetParseError());
+        return false;
+    }
+
+    for (const ConfigValue &value : SCHEMA) {
+        if (!checkValue(parsed, "", value, error)) return false;
+    }
+
+    const rapidjson::Value &levels = parsed["governor"]["levels"];
+    for (rapidjson::SizeType i = 0; i < levels.Size(); ++i) {
+        for (const ConfigValue &value : GOVERNOR_LEVEL_SCHEMA) {
+            if (!checkValue(levels[i], "/governor/levels/" + to_string(i), value, error)) return false;
+        }
+    }
+    int initialLevel = parsed["governor"]["initial_level"].GetInt();
+    if (initialLevel < 0 || initialLevel >= (int)levels.Size()) {
+        error = "/governor/initial_level must index /governor/levels";
+        return false;
+    }
+
+    if (parsed["pt_cloud"]["euclidean_cluster"]["min_cluster_size"].GetInt() >
+        parsed["pt_cloud"]["euclidean_cluster"]["max_cluster_size"].GetInt()) {
+        error = "/pt_cloud/euclidean_cluster/min_cluster_size must not be more than max_cluster_size";
+        return false;
+    }
+    if (parsed["scene"]["rock_min_radius_mm"].GetDouble() > parsed["scene"]["rock_max_radius_mm"].GetDouble()) {
+        error = "/scene/rock_min_radius_mm must not be more than rock_max_radius_mm";
+        return false;
+    }
+
+    config.Swap(parsed);
+    return true;
+}
+
+bool loadConfig(const string &path, rapidjson::Document &config, string &error) {
+    ifstream configFile(path);
+    if (!configFile) {
+        error = "cannot open " + path;
+        return false;
+    }
+    stringstream text;
+    text << configFile.rdbuf();
+    if (!parseConfig(text.str(), config, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+string configPath() {
+    const char *configRoot = getenv("MROVER_CONFIG");
+    return string(configRoot ? configRoot : "") + "/config_percep/config.json";
+}
+
+/* --- Config Updates --- */
+bool ConfigUpdates::update(const string &text, string &error) {
+    shared_ptr<rapidjson::Document> config(new rapidjson::Document);
+    bool loaded = text.empty() ? loadConfig(configPath(), *config, error) : parseConfig(text, *config, error);
+    if (!loaded) return false;
+
+    lock_guard<mutex> lock(mut_);
+    latest_ = config;
+    ++version_;
+    return true;
+}
+
+shared_ptr<const rapidjson::Document> ConfigUpdates::poll(long &version) {
+    //Almost every call finds nothing new, so check without locking first
+    if (version_.load() == version) return nullptr;
+
+    lock_guard<mutex> lock(mut_);
+    version = version_.load();
+    return latest_;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "rapidjson/document.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/* --- Config Loading --- */
+//Parses text into config and checks every value perception reads is there
+//with the right type and in a usable range, so the stages can read it without checking
+//Returns false and describes the problem in error if not
+bool parseConfig(const std::string &text, rapidjson::Document &config, std::string &error);
+
+//Reads the file at path and parses it with parseConfig
+bool loadConfig(const std::string &path, rapidjson::Document &config, std::string &error);
+
+//Path of config_percep/config.json under $MROVER_CONFIG
+std::string configPath();
+
+/* --- Config Updates --- */
+/**
+\brief Hands reloaded configs to the stage threads
+update validates a new config and publishes it whole, a bad config is
+rejected and never seen by a stage. Each stage polls between frames and
+reconfigures itself from the snapshot it gets, so a frame is always
+processed with one consistent config. Polling with nothing new is a
+single atomic load.
+*/
+class ConfigUpdates {
+    public:
+        ConfigUpdates() : version_(0) {}
+
+        //Publishes the json in text, or the config file if text is empty
+        bool update(const std::string &text, std::string &error);
+
+        //Returns the newest config if it was published after version and
+        //moves version up to it, otherwise returns null
+        std::shared_ptr<const rapidjson::Document> poll(long &version);
+
+    private:
+        std::mutex mut_;
+        std::shared_ptr<const rapidjson::Document> latest_;
+        std::atomic<long> version_;
+};
@@ -0,0 +1,209 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "simd_kernels.hpp"
+
+//Checks the vector loops in simd_kernels.hpp against their scalar helpers
+//run over every element. Lengths go past a few vector widths so every tail
+//length is hit, and inputs start at every offset within a vector so
+//unaligned loads are too. Returns nonzero if any kernel differs.
+
+using namespace std;
+
+static const float NaN = numeric_limits<float>::quiet_NaN();
+static const float INF = numeric_limits<float>::infinity();
+
+static int failures = 0;
+
+static void check(bool ok, const string &what) {
+    if (!ok) {
+        ++failures;
+        cout << "FAIL: " << what << "\n";
+    }
+}
+
+//Same value, treating NaN as equal to NaN and telling -0 from 0
+static bool sameFloat(float a, float b) {
+    return memcmp(&a, &b, sizeof(float)) == 0 || (a != a && b != b);
+}
+
+//Values that sit on or next to every edge the kernels test, plus the
+//invalid measures the ZED gives
+static vector<float> specialDepths(float low, float high) {
+    return {NaN, -NaN, INF, -INF, 0.0f, -0.0f, numeric_limits<float>::denorm_min(),
+            low, nextafterf(low, -INF), nextafterf(low, INF),
+            high, nextafterf(high, -INF), nextafterf(high, INF),
+            0.5f, 1.5f, 2.5f, -0.5f, -2.5f, 32767.4f, 32767.5f, -32768.5f, 1e6f, -1e6f,
+            numeric_limits<float>::max(), -numeric_limits<float>::max()};
+}
+
+//Fills n floats, a third of them special values and the rest spread
+//across and past the kernel's range
+static vector<float> randomFloats(mt19937 &rng, size_t n, float low, float high) {
+    vector<float> specials = specialDepths(low, high);
+    uniform_real_distribution<float> spread(low - (high - low), high + (high - low));
+    uniform_int_distribution<size_t> pick(0, specials.size() * 3 - 1);
+    vector<float> out(n);
+    for (float &v : out) {
+        size_t i = pick(rng);
+        v = i < specials.size() ? specials[i] : spread(rng);
+    }
+    return out;
+}
+
+/* --- Crop And Pack --- */
+static void testCropAndPack(mt19937 &rng) {
+    const PassThroughBounds bounds(-1500.0f, 7000.0f, 1500.0f);
+
+    for (size_t numPoints = 0; numPoints <= 4 * simd::LANES + 3; ++numPoints) {
+        for (int offset = 0; offset < simd::LANES; ++offset) {
+            for (int trial = 0; trial < 20; ++trial) {
+                //Offset by whole floats so the points start off a 16 byte boundary
+                vector<float> buffer = randomFloats(rng, 4 * numPoints + offset, bounds.low, bounds.upperZ);
+                const float *xyzrgba = buffer.data() + offset;
+
+                //Points at the origin are how recorded clouds mark invalid measures
+                if (numPoints > 0 && trial % 4 == 0) {
+                    float *origin = buffer.data() + offset + 4 * (trial % numPoints);
+                    origin[0] = origin[1] = origin[2] = 0.0f;
+                }
+
+                CompactCloud vectorCloud;
+                cropAndPack(xyzrgba, numPoints, bounds, vectorCloud);
+
+                CompactCloud scalarCloud;
+                for (size_t i = 0; i < numPoints; ++i) {
+                    const float *pt = xyzrgba + 4 * i;
+                    if (bounds.keep(pt[0], pt[1], pt[2])) {
+                        scalarCloud.push_back(toCompact(pt[0]), toCompact(pt[1]), toCompact(pt[2]));
+                    }
+                }
+
+                string what = "cropAndPack with " + to_string(numPoints) + " points at offset " + to_string(offset);
+                check(vectorCloud.x == scalarCloud.x && vectorCloud.y == scalarCloud.y &&
+                      vectorCloud.z == scalarCloud.z, what);
+            }
+        }
+    }
+}
+
+/* --- Depth Row Sweep --- */
+static void testSweepDepthRow(mt19937 &rng) {
+    DepthObstacleBounds bounds;
+    bounds.maxRange = 7000.0f;
+    bounds.lowestDrop = 200.0f;
+    bounds.highestDrop = 650.0f;
+    //k > 1 and k < 0 put drops on both sides of the band, and powers of two
+    //let depths land exactly on its edges
+    const float ks[] = {0.0f, 0.0625f, 0.1f, 0.25f, 0.5f, 1.3f, -0.2f};
+
+    for (int cols = 0; cols <= 4 * simd::LANES + 3; ++cols) {
+        for (int offset = 0; offset < simd::LANES; ++offset) {
+            //Rows, nearest and hits all start off a 16 byte boundary
+            vector<float> vectorNearest(cols + offset, INF);
+            vector<int> vectorHits(cols + offset, 0);
+            vector<float> scalarNearest(cols + offset, INF);
+            vector<int> scalarHits(cols + offset, 0);
+
+            for (float k : ks) {
+                vector<float> row = randomFloats(rng, cols + offset, 0.0f, bounds.maxRange);
+                if (k != 0.0f) {
+                    const float edges[] = {bounds.lowestDrop / k, bounds.highestDrop / k};
+                    for (int c = offset; c < cols + offset; c += 3) {
+                        float edge = edges[(c / 3) % 2];
+                        row[c] = c % 2 ? edge : nextafterf(edge, (c / 6) % 2 ? INF : -INF);
+                    }
+                }
+                sweepDepthRow(row.data() + offset, cols, k, bounds,
+                              vectorNearest.data() + offset, vectorHits.data() + offset);
+
+                for (int c = offset; c < cols + offset; ++c) {
+                    float z = row[c];
+                    if (bounds.isObstacle(z, k)) {
+                        ++scalarHits[c];
+                        if (z < scalarNearest[c]) scalarNearest[c] = z;
+                    }
+                }
+            }
+
+            bool same = vectorHits == scalarHits;
+            for (int c = 0; c < cols + offset; ++c) same = same && sameFloat(vectorNearest[c], scalarNearest[c]);
+            check(same, "sweepDepthRow with " + to_string(cols) + " columns at offset " + to_string(offset));
+        }
+    }
+}
+
+/* --- BGRA To Gray --- */
+static void testBgraToGray(mt19937 &rng) {
+    uniform_int_distribution<int> byte(0, 255);
+
+    for (size_t numPixels = 0; numPixels <= 4 * simd::LANES + 3; ++numPixels) {
+        //Offset by single bytes, so pixels don't even start on a 4 byte boundary
+        for (int offset = 0; offset < 4 * simd::LANES; ++offset) {
+            vector<uint8_t> bgra(4 * numPixels + offset);
+            for (uint8_t &v : bgra) v = (uint8_t)byte(rng);
+            //The extremes, where rounding is most likely to be off by one
+            if (numPixels > 1) {
+                memset(bgra.data() + offset, 255, 4);
+                memset(bgra.data() + offset + 4, 0, 4);
+            }
+
+            vector<uint8_t> vectorGray(numPixels + offset, 0);
+            bgraToGray(bgra.data() + offset, vectorGray.data() + offset, numPixels);
+
+            vector<uint8_t> scalarGray(numPixels + offset, 0);
+            for (size_t i = 0; i < numPixels; ++i) {
+                const uint8_t *px = bgra.data() + offset + 4 * i;
+                scalarGray[offset + i] = grayOf(px[0], px[1], px[2]);
+            }
+
+            check(vectorGray == scalarGray,
+                  "bgraToGray with " + to_string(numPixels) + " pixels at offset " + to_string(offset));
+        }
+    }
+
+    //Every color, a red level at a time, so each rounding edge is hit
+    vector<uint8_t> bgra(4 * 256 * 256);
+    vector<uint8_t> gray(256 * 256);
+    bool same = true;
+    for (int red = 0; red < 256; ++red) {
+        for (size_t i = 0; i < gray.size(); ++i) {
+            bgra[4 * i] = (uint8_t)i;
+            bgra[4 * i + 1] = (uint8_t)(i >> 8);
+            bgra[4 * i + 2] = (uint8_t)red;
+            bgra[4 * i + 3] = 255;
+        }
+        bgraToGray(bgra.data(), gray.data(), gray.size());
+        for (size_t i = 0; i < gray.size(); ++i) {
+            same = same && gray[i] == grayOf(bgra[4 * i], bgra[4 * i + 1], bgra[4 * i + 2]);
+        }
+    }
+    check(same, "bgraToGray over every color");
+}
+
+int main() {
+    mt19937 rng(2023);
+
+    #if SIMD_NEON
+    cout << "Testing the NEON back end\n";
+    #elif SIMD_SSE2
+    cout << "Testing the SSE2 back end\n";
+    #else
+    cout << "Testing the scalar back end\n";
+    #endif
+
+    testCropAndPack(rng);
+    testSweepDepthRow(rng);
+    testBgraToGray(rng);
+
+    if (failures) {
+        cout << failures << " checks failed\n";
+        return 1;
+    }
+    cout << "All SIMD kernels match the scalar path\n";
+    return 0;
+}
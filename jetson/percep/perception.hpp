@@ -16,22 +16,22 @@
 #include <thread>
 #include <fstream>
 #include "rapidjson/document.h"
+#include "telemetry.hpp"
 
 #if OBSTACLE_DETECTION
 /* --- PCL Includes --- */
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/common/common_headers.h>
 #include <pcl/point_types.h>
-#include <pcl/filters/passthrough.h>
 #include <pcl/common/time.h>
 #include <pcl/segmentation/sac_segmentation.h>
+#include <pcl/common/centroid.h>
+#include <pcl/common/eigen.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/PointIndices.h>
 #include <pcl/ModelCoefficients.h>
-#include <pcl/kdtree/kdtree.h>
 #include <pcl/sample_consensus/method_types.h>
 #include <pcl/sample_consensus/model_types.h>
-#include <pcl/segmentation/extract_clusters.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
 #include <pcl/visualization/pcl_visualizer.h>
@@ -70,7 +70,7 @@ class obstacle_return {
                   leftBearing{left_bearing_in}, rightBearing{right_bearing_in}, 
                   distance{distance_in} {}
 
-  obstacle_return& operator=(obstacle_return & in){
+  obstacle_return& operator=(const obstacle_return & in){
     if(this == &in){
       return *this;
     }
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "perception.hpp"
+#include "buffer_pool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/* --- Frame --- */
+//Everything captured from the camera for one grab, tagged with the
+//sequence number it was grabbed with so stages can tell how stale it is
+//Frames come from a BufferPool, so the Mats and cloud keep their
+//allocations from one use to the next
+struct Frame {
+    long seq = -1;
+    std::chrono::steady_clock::time_point grabTime;
+
+    #if AR_DETECTION
+    cv::Mat rgb;
+    #endif
+
+    //Copied for AR detection, or for depth obstacle detection
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    cv::Mat depth;
+    #endif
+
+    #if OBSTACLE_DETECTION
+    CompactCloud cloud;
+    #endif
+};
+
+/* --- Frame Queue --- */
+/**
+\brief Bounded queue handing frames from the capture thread to a stage
+When the queue is full the oldest frame is dropped, so a stage that falls
+behind always picks up the newest frame instead of working through a backlog
+*/
+template <typename T>
+class FrameQueue {
+    public:
+        FrameQueue(size_t capacity) : capacity_(capacity), closed_(false), dropped_(0) {}
+
+        //Adds item, dropping the oldest queued item if full
+        //Returns false if an item was dropped
+        bool push(T item) {
+            bool dropped = false;
+            {
+                std::unique_lock<std::mutex> lock(mut_);
+                if (items_.size() >= capacity_) {
+                    items_.pop_front();
+                    ++dropped_;
+                    dropped = true;
+                }
+                items_.push_back(std::move(item));
+            }
+            cv_.notify_one();
+            return !dropped;
+        }
+
+        //Blocks until an item is available and moves it into item
+        //Returns false once the queue is closed and drained
+        bool pop(T &item) {
+            std::unique_lock<std::mutex> lock(mut_);
+            cv_.wait(lock, [&]() {
+                return !items_.empty() || closed_;
+            });
+            if (items_.empty()) return false;
+            item = std::move(items_.front());
+            items_.pop_front();
+            return true;
+        }
+
+        //Wakes up any waiting stage, pop returns false once the queue is empty
+        void close() {
+            {
+                std::unique_lock<std::mutex> lock(mut_);
+                closed_ = true;
+            }
+            cv_.notify_all();
+        }
+
+        //Total number of frames this queue has dropped
+        long dropped() const {
+            return dropped_.load();
+        }
+
+    private:
+        size_t capacity_;
+        bool closed_;
+        std::atomic<long> dropped_;
+        std::deque<T> items_;
+        std::mutex mut_;
+        std::condition_variable cv_;
+};
+
+/* --- Steady State Check --- */
+/**
+\brief Catches frame copies that still allocate once the pipeline is warm
+The frame pool only counts frames, so this also watches the buffers inside
+them. before notes where a pooled frame's Mats and cloud keep their data,
+and after checks them once the grab has been copied in. From warmupFrames
+on, a Mat that moved, a cloud that outgrew its capacity or a new frame from
+the pool is a steady state allocation.
+*/
+class SteadyStateCheck {
+    public:
+        SteadyStateCheck(long warmupFrames) : WARMUP_FRAMES(warmupFrames), warmPoolAllocations(-1), allocations_(0) {}
+
+        //Call before copying a grab into frame
+        void before(const Frame &frame) {
+            held = buffersOf(frame);
+        }
+
+        //Call once grab seq is copied into frame, with the pool's allocation count
+        //Returns false if the copy or the pool allocated after warmup
+        bool after(long seq, const Frame &frame, long poolAllocations) {
+            if (seq < WARMUP_FRAMES) return true;
+            if (warmPoolAllocations < 0) warmPoolAllocations = poolAllocations;
+
+            Buffers now = buffersOf(frame);
+            //A frame that held nothing is new to the pool, which the allocation count catches
+            bool reused = held.rgb || held.depth || held.cloudCapacity;
+            bool steady = poolAllocations == warmPoolAllocations &&
+                          (!reused || (now.rgb == held.rgb && now.depth == held.depth &&
+                                       now.cloudCapacity == held.cloudCapacity));
+            warmPoolAllocations = poolAllocations;
+            if (!steady) ++allocations_;
+            return steady;
+        }
+
+        //Number of frames that allocated after warmup
+        long allocations() const {
+            return allocations_;
+        }
+
+    private:
+        struct Buffers {
+            const void *rgb = nullptr;
+            const void *depth = nullptr;
+            size_t cloudCapacity = 0;
+        };
+
+        static Buffers buffersOf(const Frame &frame) {
+            Buffers buffers;
+            #if AR_DETECTION
+            buffers.rgb = frame.rgb.data;
+            #endif
+            #if AR_DETECTION || OBSTACLE_DETECTION
+            buffers.depth = frame.depth.data;
+            #endif
+            #if OBSTACLE_DETECTION
+            buffers.cloudCapacity = frame.cloud.capacity();
+            #endif
+            return buffers;
+        }
+
+        long WARMUP_FRAMES;
+        long warmPoolAllocations;
+        long allocations_;
+        Buffers held;
+};
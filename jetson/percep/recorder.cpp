@@ -0,0 +1,178 @@
+#include "recorder.hpp"
+#include "camera.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <limits>
+
+using namespace std;
+
+/* --- Raw Depth Files --- */
+static const char DEPTH_MAGIC[4] = { 'M', 'R', 'D', '1' };
+
+bool writeRawDepth(const string &filename, const cv::Mat &depth) {
+    //Whole mm are as fine as the ZED resolves, and 65 m is well past its range
+    cv::Mat mm(depth.size(), CV_16UC1);
+    for (int r = 0; r < depth.rows; ++r) {
+        const float *in = depth.ptr<float>(r);
+        uint16_t *out = mm.ptr<uint16_t>(r);
+        for (int c = 0; c < depth.cols; ++c) {
+            float d = in[c];
+            out[c] = (d > 0.0f && d < 65535.0f) ? (uint16_t)(d + 0.5f) : 0;
+        }
+    }
+
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (!file) return false;
+    int32_t size[2] = { mm.rows, mm.cols };
+    bool ok = fwrite(DEPTH_MAGIC, sizeof(DEPTH_MAGIC), 1, file) == 1 &&
+              fwrite(size, sizeof(size), 1, file) == 1 &&
+              fwrite(mm.data, mm.total() * mm.elemSize(), 1, file) == 1;
+    return fclose(file) == 0 && ok;
+}
+
+cv::Mat readRawDepth(const string &filename) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file) return cv::Mat();
+
+    char magic[4];
+    int32_t size[2];
+    cv::Mat mm;
+    if (fread(magic, sizeof(magic), 1, file) == 1 && equal(magic, magic + 4, DEPTH_MAGIC) &&
+        fread(size, sizeof(size), 1, file) == 1 && size[0] > 0 && size[1] > 0) {
+        mm.create(size[0], size[1], CV_16UC1);
+        if (fread(mm.data, mm.total() * mm.elemSize(), 1, file) != 1) mm.release();
+    }
+    fclose(file);
+    if (mm.empty()) return mm;
+
+    cv::Mat depth(mm.size(), CV_32FC1);
+    for (int r = 0; r < mm.rows; ++r) {
+        const uint16_t *in = mm.ptr<uint16_t>(r);
+        float *out = depth.ptr<float>(r);
+        for (int c = 0; c < mm.cols; ++c) {
+            out[c] = in[c] ? (float)in[c] : numeric_limits<float>::quiet_NaN();
+        }
+    }
+    return depth;
+}
+
+/* --- Frame Recorder --- */
+//Creates every missing folder along path, like mkdir -p
+static bool makeFolder(const string &path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        string prefix = path.substr(0, slash);
+        if (!prefix.empty() && mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == string::npos) return true;
+    }
+}
+
+FrameRecorder::FrameRecorder(const rapidjson::Document &config, const string &folder, bool enabled) :
+    rgbFolder{folder + "rgb/"},
+    depthFolder{folder + "depth/"},
+    pclFolder{folder + "pcl/"},
+    foldersMade{false},
+    FRAME_WRITE_INTERVAL{config["camera"]["frame_write_interval"].GetInt()},
+    PCD_FORMAT{config["recorder"]["pcd_format"].GetString()},
+    enabled_{enabled},
+    written{0},
+    poolDrops{0},
+    copies{(size_t)config["recorder"]["queue_depth"].GetInt() + 2},
+    queue{(size_t)config["recorder"]["queue_depth"].GetInt()} {
+
+    writer = thread([this]() {
+        shared_ptr<RecordedFrame> frame;
+        while (queue.pop(frame)) {
+            write(*frame);
+            //Hand the copy back to the pool as soon as it is on disk
+            frame.reset();
+        }
+    });
+}
+
+FrameRecorder::~FrameRecorder() {
+    //Finish writing whatever was queued before shutting down
+    queue.close();
+    writer.join();
+}
+
+void FrameRecorder::submit(const Frame &frame, Camera &cam) {
+    if (!enabled_ || frame.seq % FRAME_WRITE_INTERVAL != 0) return;
+
+    //A full queue drops its oldest copy back to the pool, so this only fails
+    //if a dropped copy hasn't been released yet
+    shared_ptr<RecordedFrame> copy = copies.acquire();
+    if (!copy) {
+        ++poolDrops;
+        return;
+    }
+
+    //copyTo only allocates the first time a pooled copy is used
+    #if AR_DETECTION
+    frame.rgb.copyTo(copy->rgb);
+    #endif
+
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    frame.depth.copyTo(copy->depth);
+    #endif
+
+    #if OBSTACLE_DETECTION
+    //No cloud is grabbed when obstacles are found from the depth image
+    copy->hasCloud = cam.getRecordCloud(copy->cloud);
+    #endif
+
+    queue.push(std::move(copy));
+}
+
+void FrameRecorder::setEnabled(bool enabled) {
+    enabled_ = enabled;
+}
+
+bool FrameRecorder::enabled() const {
+    return enabled_;
+}
+
+long FrameRecorder::dropped() const {
+    return queue.dropped() + poolDrops.load();
+}
+
+bool FrameRecorder::makeFolders() {
+    if (foldersMade) return true;
+    foldersMade = makeFolder(rgbFolder) && makeFolder(depthFolder) && makeFolder(pclFolder);
+    if (!foldersMade) {
+        cerr << "Could not create recording folders in " << rgbFolder << "\n";
+    }
+    return foldersMade;
+}
+
+void FrameRecorder::write(const RecordedFrame &frame) {
+    if (!makeFolders()) return;
+
+    //Zero padded so the offline camera replays them in order
+    char fileName[16];
+    snprintf(fileName, sizeof(fileName), "%06ld", written++);
+
+    #if AR_DETECTION
+    cv::imwrite(rgbFolder + fileName + ".jpg", frame.rgb);
+    #endif
+
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    if (!frame.depth.empty() && !writeRawDepth(depthFolder + fileName + ".depth", frame.depth)) {
+        cerr << "Could not write " << depthFolder << fileName << ".depth\n";
+    }
+    #endif
+
+    #if OBSTACLE_DETECTION
+    if (!frame.hasCloud) return;
+    string pcdName = pclFolder + fileName + ".pcd";
+    try {
+        if (PCD_FORMAT == "binary_compressed") pcl::io::savePCDFileBinaryCompressed(pcdName, frame.cloud);
+        else if (PCD_FORMAT == "binary") pcl::io::savePCDFileBinary(pcdName, frame.cloud);
+        else pcl::io::savePCDFileASCII(pcdName, frame.cloud);
+    }
+    catch (pcl::IOException &e) {
+        cerr << e.what() << "\n";
+    }
+    #endif
+}
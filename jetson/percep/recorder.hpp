@@ -0,0 +1,86 @@
+#pragma once
+
+#include "pipeline.hpp"
+#include "buffer_pool.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+
+class Camera;
+
+/* --- Raw Depth Files --- */
+//Depth is stored as a small header followed by one little endian uint16 per
+//pixel holding the depth in whole mm, with 0 for invalid measures. Half the
+//size of a float EXR and written with a single fwrite.
+//Returns false if the file could not be written
+bool writeRawDepth(const std::string &filename, const cv::Mat &depth);
+
+//Reads a depth file back into a CV_32FC1 Mat in mm, invalid measures are NaN
+//Returns an empty Mat if the file could not be read
+cv::Mat readRawDepth(const std::string &filename);
+
+/* --- Frame Recorder --- */
+//What the recorder keeps of a frame until it is written
+struct RecordedFrame {
+    #if AR_DETECTION
+    cv::Mat rgb;
+    #endif
+
+    //Empty when the pipeline didn't copy depth for this frame
+    #if AR_DETECTION || OBSTACLE_DETECTION
+    cv::Mat depth;
+    #endif
+
+    #if OBSTACLE_DETECTION
+    //The camera's cloud before cropping and compaction, so recordings keep color
+    bool hasCloud = false;
+    pcl::PointCloud<pcl::PointXYZRGB> cloud;
+    #endif
+};
+
+/**
+\brief Writes frames to disk on its own thread
+Capture hands every frame to submit, which copies the ones due to be recorded
+into the recorder's own buffers and returns straight away, so pipeline frames
+go back to the frame pool at the same pace whether or not the disk keeps up.
+The copies come from a pool capped at the queue depth plus the frame being
+written and one spare, so if the disk falls behind the queue drops its oldest
+frame rather than holding up capture or growing. Recording can be switched on
+and off at any time, frames already queued are still written.
+*/
+class FrameRecorder {
+    public:
+        FrameRecorder(const rapidjson::Document &config, const std::string &folder, bool enabled);
+        ~FrameRecorder();
+
+        //Queues a copy of frame if recording is on and it is due to be recorded
+        //Must be called before cam grabs again, clouds are copied from cam since
+        //frames only hold the compacted cloud
+        void submit(const Frame &frame, Camera &cam);
+
+        void setEnabled(bool enabled);
+        bool enabled() const;
+
+        //Number of frames dropped because the disk couldn't keep up
+        long dropped() const;
+
+    private:
+        //Creates the output folders on first use
+        bool makeFolders();
+        void write(const RecordedFrame &frame);
+
+        std::string rgbFolder;
+        std::string depthFolder;
+        std::string pclFolder;
+        bool foldersMade;
+
+        int FRAME_WRITE_INTERVAL;
+        std::string PCD_FORMAT;
+
+        std::atomic<bool> enabled_;
+        long written;
+        std::atomic<long> poolDrops;
+        BufferPool<RecordedFrame> copies;
+        FrameQueue<std::shared_ptr<RecordedFrame>> queue;
+        std::thread writer;
+};
@@ -0,0 +1,92 @@
+#include "resolution_governor.hpp"
+#include <algorithm>
+
+ResolutionGovernor::ResolutionGovernor(const rapidjson::Document &config) :
+    level{0}, ENABLED{config["governor"]["enabled"].GetInt() != 0},
+    BUDGET_MS{config["governor"]["budget_ms"].GetDouble()},
+    STEP_DOWN_FRACTION{config["governor"]["step_down_fraction"].GetDouble()},
+    STEP_UP_FRACTION{config["governor"]["step_up_fraction"].GetDouble()},
+    WINDOW_FRAMES{std::max(config["governor"]["window_frames"].GetInt(), 1)},
+    STEP_UP_WINDOWS{std::max(config["governor"]["step_up_windows"].GetInt(), 1)},
+    lastP90Ms{0}, quietWindows{0}, steps{0} {
+
+    if (!ENABLED) {
+        const rapidjson::Value &ptCloud = config["pt_cloud"];
+        levels.push_back({ ptCloud["pt_cloud_width"].GetInt(), ptCloud["pt_cloud_height"].GetInt(),
+                           ptCloud["downsample_voxel_filter"].GetFloat(), ptCloud["ransac"]["max_iterations"].GetInt() });
+        return;
+    }
+
+    for (const auto &entry : config["governor"]["levels"].GetArray()) {
+        levels.push_back({ entry["cloud_width"].GetInt(), entry["cloud_height"].GetInt(),
+                           entry["leaf_size"].GetFloat(), entry["ransac_iterations"].GetInt() });
+    }
+    level = config["governor"]["initial_level"].GetInt();
+    window.reserve(WINDOW_FRAMES);
+}
+
+bool ResolutionGovernor::enabled() const {
+    return ENABLED;
+}
+
+OperatingPoint ResolutionGovernor::point() const {
+    //Levels never change after construction so only the index needs to be atomic
+    return levels[level.load(std::memory_order_relaxed)];
+}
+
+size_t ResolutionGovernor::maxCloudPoints() const {
+    size_t most = 0;
+    for (const OperatingPoint &operatingPoint : levels) {
+        most = std::max(most, (size_t)operatingPoint.cloudWidth * operatingPoint.cloudHeight);
+    }
+    return most;
+}
+
+bool ResolutionGovernor::record(std::chrono::steady_clock::duration latency) {
+    if (!ENABLED) return false;
+
+    window.push_back(std::chrono::duration<double, std::milli>(latency).count());
+    if ((int)window.size() < WINDOW_FRAMES) return false;
+
+    auto p90 = window.begin() + (window.size() * 9) / 10;
+    std::nth_element(window.begin(), p90, window.end());
+    lastP90Ms = *p90;
+    window.clear();
+
+    int current = level.load(std::memory_order_relaxed);
+    int next = current;
+    if (lastP90Ms > BUDGET_MS * STEP_DOWN_FRACTION) {
+        quietWindows = 0;
+        next = std::min(current + 1, (int)levels.size() - 1);
+    }
+    else if (lastP90Ms < BUDGET_MS * STEP_UP_FRACTION) {
+        //Only climb once there has been headroom for a while
+        if (++quietWindows >= STEP_UP_WINDOWS) {
+            quietWindows = 0;
+            next = std::max(current - 1, 0);
+        }
+    }
+    else {
+        quietWindows = 0;
+    }
+
+    if (next != current) {
+        level.store(next, std::memory_order_relaxed);
+        ++steps;
+    }
+    return true;
+}
+
+void ResolutionGovernor::status(rover_msgs::PerceptionGovernor &out) const {
+    int current = level.load(std::memory_order_relaxed);
+    const OperatingPoint &op = levels[current];
+    out.level = current;
+    out.num_levels = levels.size();
+    out.cloud_width = op.cloudWidth;
+    out.cloud_height = op.cloudHeight;
+    out.leaf_size = op.leafSize;
+    out.ransac_iterations = op.ransacIterations;
+    out.budget_ms = BUDGET_MS;
+    out.window_p90_ms = lastP90Ms;
+    out.steps = steps;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "rapidjson/document.h"
+#include "rover_msgs/PerceptionGovernor.hpp"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+/* --- Operating Point --- */
+//Obstacle detection settings the governor steps between
+struct OperatingPoint {
+    int cloudWidth;
+    int cloudHeight;
+    float leafSize;
+    int ransacIterations;
+};
+
+/* --- Resolution Governor --- */
+/**
+\brief Keeps obstacle detection inside its per frame time budget
+Levels go from most to least detail. At the end of every window of frames
+the governor takes the window's p90 detection time: over step_down_fraction
+of the budget it drops a level right away, under step_up_fraction for
+step_up_windows windows in a row it climbs one. The gap between the two
+fractions and the wait before climbing keep it from flapping between levels.
+When disabled it holds the pt_cloud settings.
+record is called from the obstacle thread, point is safe from any thread.
+*/
+class ResolutionGovernor {
+    public:
+        ResolutionGovernor(const rapidjson::Document &config);
+
+        bool enabled() const;
+
+        //Settings for the next frame
+        OperatingPoint point() const;
+
+        //Most points any level grabs, so frames can be sized for every level up front
+        size_t maxCloudPoints() const;
+
+        //Adds one frame's obstacle detection time
+        //Returns true when it closed a window, status is then worth publishing
+        bool record(std::chrono::steady_clock::duration latency);
+
+        //Fills out with the current operating point and the last window
+        void status(rover_msgs::PerceptionGovernor &out) const;
+
+    private:
+        std::vector<OperatingPoint> levels;
+        std::atomic<int> level;
+        bool ENABLED;
+
+        double BUDGET_MS;
+        double STEP_DOWN_FRACTION;
+        double STEP_UP_FRACTION;
+        int WINDOW_FRAMES;
+        int STEP_UP_WINDOWS;
+
+        //Detection times of the current window in ms
+        std::vector<double> window;
+        double lastP90Ms;
+        int quietWindows;
+        long steps;
+};
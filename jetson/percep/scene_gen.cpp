@@ -0,0 +1,519 @@
+#include "perception.hpp"
+#include "percep_config.hpp"
+#include "recorder.hpp"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/prettywriter.h"
+#include <cerrno>
+#include <climits>
+#include <stdexcept>
+#include <random>
+
+using namespace cv;
+using namespace std;
+
+/* --- Synthetic Scene Generator --- */
+//Drives a virtual ZED over generated terrain and writes every frame in the
+//layout FrameRecorder writes and the offline camera reads: rgb/*.jpg,
+//depth/*.depth and an organized pcl/*.pcd. The rocks and tag posts in view
+//are written to truth/*.json next to them, so a run of the benchmark or the
+//perception binary on the folder can be checked against what was there.
+
+static void usage(const char *prog) {
+    cerr << "Usage: " << prog << " <output folder> [--frames N] [--seed N] [--rocks N] [--tags N]"
+         << " [--image WxH] [--cloud WxH]\n";
+}
+
+struct SceneSettings {
+    int frames;
+    int seed;
+    int imageWidth;
+    int imageHeight;
+    int cloudWidth;
+    int cloudHeight;
+    double fov;
+    double cameraHeight;
+    double cameraTilt;
+    double speed;
+    double slope;
+    double roughness;
+    int rocks;
+    double rockMinRadius;
+    double rockMaxRadius;
+    int tags;
+    double tagSize;
+    double postHeight;
+    double spread;
+    double minRange;
+    double maxRange;
+    double depthNoise;
+    double dropout;
+
+    SceneSettings(const rapidjson::Document &config) :
+        frames{config["scene"]["frames"].GetInt()},
+        seed{config["scene"]["seed"].GetInt()},
+        imageWidth{config["scene"]["image_width"].GetInt()},
+        imageHeight{config["scene"]["image_height"].GetInt()},
+        cloudWidth{config["pt_cloud"]["pt_cloud_width"].GetInt()},
+        cloudHeight{config["pt_cloud"]["pt_cloud_height"].GetInt()},
+        fov{config["scene"]["horizontal_fov_deg"].GetDouble() * PI / 180},
+        cameraHeight{config["scene"]["camera_height_mm"].GetDouble()},
+        cameraTilt{config["scene"]["camera_tilt_deg"].GetDouble() * PI / 180},
+        speed{config["scene"]["speed_mm_per_frame"].GetDouble()},
+        slope{config["scene"]["slope_deg"].GetDouble() * PI / 180},
+        roughness{config["scene"]["roughness_mm"].GetDouble()},
+        rocks{config["scene"]["rocks"].GetInt()},
+        rockMinRadius{config["scene"]["rock_min_radius_mm"].GetDouble()},
+        rockMaxRadius{config["scene"]["rock_max_radius_mm"].GetDouble()},
+        tags{config["scene"]["tags"].GetInt()},
+        tagSize{config["scene"]["tag_size_mm"].GetDouble()},
+        postHeight{config["scene"]["tag_post_height_mm"].GetDouble()},
+        spread{config["scene"]["spread_mm"].GetDouble()},
+        minRange{config["scene"]["min_range_mm"].GetDouble()},
+        maxRange{config["scene"]["max_range_mm"].GetDouble()},
+        depthNoise{config["scene"]["depth_noise_mm"].GetDouble()},
+        dropout{config["scene"]["dropout"].GetDouble()} {}
+};
+
+struct Rock {
+    Vec3d center;
+    double radius;
+};
+
+struct TagPost {
+    int id;
+    Vec3d base;   //Where the post meets the ground
+    Vec3d center; //Center of the tag, which faces the rover
+};
+
+/* --- Scene --- */
+/**
+\brief Ray casts a rover's eye view of rocks and tag posts on a sloped plane
+Coordinates are in mm like the ZED's, x right, y down and z forward. The world
+frame is the rover's at the first frame, and the rover drives straight along
+z at speed_mm_per_frame, keeping camera_height_mm above the ground. Depth
+noise grows with the square of depth like stereo matching error does.
+*/
+class Scene {
+    public:
+        Scene(const SceneSettings &settings, const Mat &markers, int markerPixels);
+
+        //Renders a width x height view from the camera at frame into bgr
+        //(CV_8UC3) and xyz (CV_32FC3 camera frame points, NaN where nothing is hit)
+        void render(int frame, int width, int height, Mat &bgr, Mat &xyz);
+
+        //Writes what is in front of the camera at frame as JSON
+        bool writeTruth(int frame, const string &path);
+
+    private:
+        double groundY(double x, double z) const;
+        Vec3d cameraOrigin(int frame) const;
+        Vec3d toWorld(const Vec3d &camera) const;
+        Vec3d toCamera(int frame, const Vec3d &world) const;
+
+        //Nearest hit along the ray, returns false if it hits nothing
+        bool trace(const Vec3d &origin, const Vec3d &dir, double &distance, Vec3b &color) const;
+
+        const SceneSettings &settings_;
+        vector<Rock> rocks_;
+        vector<TagPost> posts_;
+
+        //Marker images of every tag id side by side, markerPixels_ square each
+        Mat markers_;
+        int markerPixels_;
+
+        mt19937 noise_;
+};
+
+static const double POST_RADIUS = 25;
+//Direction the light comes from: above, left and behind the rover
+static const Vec3d LIGHT = normalize(Vec3d(-0.4, -1, -0.3));
+static const Vec3b SKY(235, 206, 135);
+static const Vec3b SOIL(90, 140, 180);
+static const Vec3b STONE(110, 110, 120);
+static const Vec3b POST(200, 200, 200);
+
+Scene::Scene(const SceneSettings &settings, const Mat &markers, int markerPixels) :
+    settings_(settings), markers_(markers), markerPixels_(markerPixels), noise_(settings.seed) {
+    mt19937 placement(settings.seed);
+    //Objects are spread over everything the rover will see while driving
+    uniform_real_distribution<double> x(-settings.spread, settings.spread);
+    uniform_real_distribution<double> z(settings.minRange, settings.maxRange + settings.frames * settings.speed);
+    uniform_real_distribution<double> radius(settings.rockMinRadius, settings.rockMaxRadius);
+
+    for (int i = 0; i < settings.rocks; ++i) {
+        Rock rock;
+        rock.radius = radius(placement);
+        double rx = x(placement), rz = z(placement);
+        //Half buried, so the top sits a radius above the ground
+        rock.center = Vec3d(rx, groundY(rx, rz), rz);
+        rocks_.push_back(rock);
+    }
+
+    int numIds = markers.cols / markerPixels;
+    for (int i = 0; i < settings.tags; ++i) {
+        TagPost post;
+        post.id = i % numIds;
+        double px = x(placement), pz = z(placement);
+        post.base = Vec3d(px, groundY(px, pz), pz);
+        //The tag hangs from the top of the post with its white margin
+        post.center = Vec3d(px, post.base[1] - settings.postHeight + settings.tagSize * 0.7, pz - POST_RADIUS);
+        posts_.push_back(post);
+    }
+}
+
+//Height of the ground, y is down so a rising slope ahead lowers it
+double Scene::groundY(double x, double z) const {
+    return -z * tan(settings_.slope) +
+           settings_.roughness * sin(x / 700.0) * cos(z / 900.0);
+}
+
+Vec3d Scene::cameraOrigin(int frame) const {
+    double z = frame * settings_.speed;
+    return Vec3d(0, groundY(0, z) - settings_.cameraHeight, z);
+}
+
+//The camera is pitched down by camera_tilt_deg
+Vec3d Scene::toWorld(const Vec3d &camera) const {
+    double c = cos(settings_.cameraTilt), s = sin(settings_.cameraTilt);
+    return Vec3d(camera[0], camera[1] * c + camera[2] * s, -camera[1] * s + camera[2] * c);
+}
+
+Vec3d Scene::toCamera(int frame, const Vec3d &world) const {
+    Vec3d rel = world - cameraOrigin(frame);
+    double c = cos(settings_.cameraTilt), s = sin(settings_.cameraTilt);
+    return Vec3d(rel[0], rel[1] * c - rel[2] * s, rel[1] * s + rel[2] * c);
+}
+
+bool Scene::trace(const Vec3d &origin, const Vec3d &dir, double &distance, Vec3b &color) const {
+    distance = numeric_limits<double>::infinity();
+    Vec3d normal;
+    Vec3b base;
+
+    //Ground, intersected as the plane and then moved onto the bumps
+    double tanSlope = tan(settings_.slope);
+    double denominator = dir[1] + dir[2] * tanSlope;
+    if (denominator > 1e-9) {
+        double s = -(origin[1] + origin[2] * tanSlope) / denominator;
+        if (s > 0) {
+            Vec3d hit = origin + s * dir;
+            //Moving along the ray by the bump height over the ray's drop keeps it on the terrain
+            double bump = groundY(hit[0], hit[2]) + hit[2] * tanSlope;
+            s += bump / denominator;
+            if (s > 0) {
+                distance = s;
+                normal = Vec3d(0, -1, 0);
+                //Patchy soil so the ground has texture for stereo and AR thresholds
+                double patch = 0.85 + 0.15 * sin(hit[0] / 130.0) * sin(hit[2] / 170.0);
+                base = Vec3b(saturate_cast<uchar>(SOIL[0] * patch), saturate_cast<uchar>(SOIL[1] * patch),
+                             saturate_cast<uchar>(SOIL[2] * patch));
+            }
+        }
+    }
+
+    for (const Rock &rock : rocks_) {
+        //dir isn't unit length, its camera frame z is 1 so that s is depth
+        Vec3d oc = origin - rock.center;
+        double a = dir.dot(dir);
+        double b = oc.dot(dir);
+        double c = oc.dot(oc) - rock.radius * rock.radius;
+        double discriminant = b * b - a * c;
+        if (discriminant < 0) continue;
+        double s = (-b - sqrt(discriminant)) / a;
+        if (s <= 0 || s >= distance) continue;
+        distance = s;
+        normal = normalize(origin + s * dir - rock.center);
+        base = STONE;
+    }
+
+    for (const TagPost &post : posts_) {
+        //Post as a vertical cylinder from the ground to its top
+        double top = post.base[1] - settings_.postHeight;
+        double dx = origin[0] - post.base[0], dz = origin[2] - post.base[2];
+        double a = dir[0] * dir[0] + dir[2] * dir[2];
+        double b = dx * dir[0] + dz * dir[2];
+        double c = dx * dx + dz * dz - POST_RADIUS * POST_RADIUS;
+        double discriminant = b * b - a * c;
+        if (a > 1e-12 && discriminant >= 0) {
+            double s = (-b - sqrt(discriminant)) / a;
+            double y = origin[1] + s * dir[1];
+            if (s > 0 && s < distance && y >= top && y <= post.base[1]) {
+                distance = s;
+                normal = normalize(Vec3d(dx + s * dir[0], 0, dz + s * dir[2]));
+                base = POST;
+            }
+        }
+
+        //Tag board facing the rover, the marker inside a white margin
+        if (dir[2] <= 1e-9) continue;
+        double s = (post.center[2] - origin[2]) / dir[2];
+        if (s <= 0 || s >= distance) continue;
+        Vec3d hit = origin + s * dir;
+        double u = (hit[0] - post.center[0]) / settings_.tagSize + 0.5;
+        double v = (hit[1] - post.center[1]) / settings_.tagSize + 0.5;
+        if (u < -0.2 || u > 1.2 || v < -0.2 || v > 1.2) continue;
+        distance = s;
+        normal = Vec3d(0, 0, -1);
+        uchar shade = 255;
+        if (u >= 0 && u < 1 && v >= 0 && v < 1) {
+            shade = markers_.at<uchar>((int)(v * markerPixels_), post.id * markerPixels_ + (int)(u * markerPixels_));
+        }
+        base = Vec3b(shade, shade, shade);
+    }
+
+    if (std::isinf(distance)) return false;
+    double light = 0.35 + 0.65 * max(0.0, normal.dot(LIGHT));
+    color = Vec3b(saturate_cast<uchar>(base[0] * light), saturate_cast<uchar>(base[1] * light),
+                  saturate_cast<uchar>(base[2] * light));
+    return true;
+}
+
+void Scene::render(int frame, int width, int height, Mat &bgr, Mat &xyz) {
+    bgr.create(height, width, CV_8UC3);
+    xyz.create(height, width, CV_32FC3);
+    const double focal = width / 2.0 / tan(settings_.fov / 2);
+    const Vec3d origin = cameraOrigin(frame);
+    const float nan = numeric_limits<float>::quiet_NaN();
+    normal_distribution<double> depthNoise(0, 1);
+    uniform_real_distribution<double> dropout(0, 1);
+
+    for (int r = 0; r < height; ++r) {
+        Vec3b *color = bgr.ptr<Vec3b>(r);
+        Vec3f *point = xyz.ptr<Vec3f>(r);
+        for (int c = 0; c < width; ++c) {
+            Vec3d ray((c + 0.5 - width / 2.0) / focal, (r + 0.5 - height / 2.0) / focal, 1);
+            double distance;
+            if (!trace(origin, toWorld(ray), distance, color[c])) {
+                color[c] = SKY;
+                point[c] = Vec3f(nan, nan, nan);
+                continue;
+            }
+
+            //The ray has unit z in the camera frame, so distance along it is depth
+            double depth = distance;
+            depth += settings_.depthNoise * (depth / 1000) * (depth / 1000) * depthNoise(noise_);
+            if (dropout(noise_) < settings_.dropout || depth <= 0) point[c] = Vec3f(nan, nan, nan);
+            else point[c] = Vec3f(ray * depth);
+        }
+    }
+}
+
+bool Scene::writeTruth(int frame, const string &path) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    auto writePoint = [&writer](const Vec3d &p) {
+        writer.StartArray();
+        for (int i = 0; i < 3; ++i) writer.Double(p[i]);
+        writer.EndArray();
+    };
+
+    writer.StartObject();
+    writer.Key("frame");
+    writer.Int(frame);
+
+    //Rocks in front of the camera and within range, nearest first. Distance is
+    //forward depth to the front of the rock, the same z the detector reports
+    vector<pair<double, const Rock *>> ahead;
+    for (const Rock &rock : rocks_) {
+        Vec3d center = toCamera(frame, rock.center);
+        double front = center[2] - rock.radius;
+        if (center[2] > 0 && front < settings_.maxRange) ahead.emplace_back(front, &rock);
+    }
+    sort(ahead.begin(), ahead.end(), [](const pair<double, const Rock *> &a, const pair<double, const Rock *> &b) {
+        return a.first < b.first;
+    });
+
+    writer.Key("obstacles");
+    writer.StartArray();
+    for (const auto &entry : ahead) {
+        Vec3d center = toCamera(frame, entry.second->center);
+        writer.StartObject();
+        writer.Key("center_mm");
+        writePoint(center);
+        writer.Key("radius_mm");
+        writer.Double(entry.second->radius);
+        writer.Key("distance_m");
+        writer.Double(entry.first / 1000);
+        writer.Key("bearing_deg");
+        writer.Double(atan2(center[0], center[2]) * 180 / PI);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    //Tags with the distance and bearing an ideal detector would report
+    const double focal = settings_.imageWidth / 2.0 / tan(settings_.fov / 2);
+    writer.Key("tags");
+    writer.StartArray();
+    for (const TagPost &post : posts_) {
+        Vec3d center = toCamera(frame, post.center);
+        if (center[2] <= 0 || center[2] > settings_.maxRange) continue;
+        double u = center[0] / center[2] * focal + settings_.imageWidth / 2.0;
+        double v = center[1] / center[2] * focal + settings_.imageHeight / 2.0;
+        writer.StartObject();
+        writer.Key("id");
+        writer.Int(post.id);
+        writer.Key("center_mm");
+        writePoint(center);
+        writer.Key("pixel");
+        writer.StartArray();
+        writer.Double(u);
+        writer.Double(v);
+        writer.EndArray();
+        writer.Key("in_view");
+        writer.Bool(u >= 0 && u < settings_.imageWidth && v >= 0 && v < settings_.imageHeight);
+        writer.Key("distance_m");
+        writer.Double(center[2] / 1000);
+        writer.Key("bearing_deg");
+        writer.Double(atan2(center[0], center[2]) * 180 / PI);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+
+    ofstream file(path);
+    file << buffer.GetString() << endl;
+    return (bool)file;
+}
+
+//Parses WxH into width and height
+static bool parseSize(const string &text, int &width, int &height) {
+    return sscanf(text.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+//Parses a whole decimal int no smaller than min
+static bool parseInt(const string &text, int &value, int min) {
+    size_t used = 0;
+    try {
+        value = stoi(text, &used);
+    }
+    catch (const logic_error &) {
+        return false;
+    }
+    return used == text.size() && value >= min;
+}
+
+int main(int argc, char **argv) {
+    /* --- Arguments --- */
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    string folder = argv[1];
+    if (folder.back() != '/') folder += "/";
+
+    rapidjson::Document mRoverConfig;
+    string configError;
+    if (!loadConfig(configPath(), mRoverConfig, configError)) {
+        cerr << "Error: " << configError << endl;
+        return 2;
+    }
+    SceneSettings settings(mRoverConfig);
+
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        if (arg == "--frames") ok = parseInt(value, settings.frames, 0);
+        else if (arg == "--seed") ok = parseInt(value, settings.seed, INT_MIN);
+        else if (arg == "--rocks") ok = parseInt(value, settings.rocks, 0);
+        else if (arg == "--tags") ok = parseInt(value, settings.tags, 0);
+        else if (arg == "--image") ok = parseSize(value, settings.imageWidth, settings.imageHeight);
+        else if (arg == "--cloud") ok = parseSize(value, settings.cloudWidth, settings.cloudHeight);
+        else ok = false;
+        if (!ok) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    /* --- Tag Markers --- */
+    //Drawn from the same dictionary the detector reads
+    cv::FileStorage fsr("jetson/percep/alvar_dict.yml", cv::FileStorage::READ);
+    if (!fsr.isOpened()) {
+        cerr << "ERR: \"alvar_dict.yml\" does not exist! Create it before running the generator\n";
+        return 2;
+    }
+    int mSize, mCBits;
+    Mat bits;
+    fsr["MarkerSize"] >> mSize;
+    fsr["MaxCorrectionBits"] >> mCBits;
+    fsr["ByteList"] >> bits;
+    fsr.release();
+    cv::aruco::Dictionary dictionary(bits, mSize, mCBits);
+
+    const int markerPixels = 120;
+    int borderBits = mRoverConfig["alvar_params"]["marker_border_bits"].GetInt();
+    int numIds = max(1, min(settings.tags, bits.rows));
+    Mat markers(markerPixels, markerPixels * numIds, CV_8UC1);
+    Mat marker;
+    for (int id = 0; id < numIds; ++id) {
+        dictionary.drawMarker(id, markerPixels, marker, borderBits);
+        marker.copyTo(markers(Rect(id * markerPixels, 0, markerPixels, markerPixels)));
+    }
+
+    /* --- Frames --- */
+    for (const string &path : { folder, folder + "rgb", folder + "depth", folder + "pcl", folder + "truth" }) {
+        if (mkdir(path.c_str(), 0755) && errno != EEXIST) {
+            cerr << "Could not create " << path << "\n";
+            return 2;
+        }
+    }
+
+    Scene scene(settings, markers, markerPixels);
+    string pcdFormat = mRoverConfig["recorder"]["pcd_format"].GetString();
+    Mat bgr, xyz, depth;
+    vector<Mat> channels;
+    auto start = chrono::steady_clock::now();
+
+    for (int frame = 0; frame < settings.frames; ++frame) {
+        //Zero padded like FrameRecorder so the offline camera replays them in order
+        char fileName[16];
+        snprintf(fileName, sizeof(fileName), "%06d", frame);
+
+        scene.render(frame, settings.imageWidth, settings.imageHeight, bgr, xyz);
+        split(xyz, channels);
+        depth = channels[2];
+        imwrite(folder + "rgb/" + fileName + ".jpg", bgr);
+        if (!writeRawDepth(folder + "depth/" + fileName + ".depth", depth)) {
+            cerr << "Could not write " << folder << "depth/" << fileName << ".depth\n";
+            return 1;
+        }
+
+        #if OBSTACLE_DETECTION
+        if (settings.cloudWidth != settings.imageWidth || settings.cloudHeight != settings.imageHeight) {
+            scene.render(frame, settings.cloudWidth, settings.cloudHeight, bgr, xyz);
+        }
+        pcl::PointCloud<pcl::PointXYZRGB> cloud(settings.cloudWidth, settings.cloudHeight);
+        cloud.is_dense = false;
+        for (int r = 0; r < settings.cloudHeight; ++r) {
+            const Vec3f *point = xyz.ptr<Vec3f>(r);
+            const Vec3b *color = bgr.ptr<Vec3b>(r);
+            for (int c = 0; c < settings.cloudWidth; ++c) {
+                pcl::PointXYZRGB &pt = cloud.at(c, r);
+                pt.x = point[c][0];
+                pt.y = point[c][1];
+                pt.z = point[c][2];
+                pt.b = color[c][0];
+                pt.g = color[c][1];
+                pt.r = color[c][2];
+            }
+        }
+        string pcdName = folder + "pcl/" + fileName + ".pcd";
+        if (pcdFormat == "binary_compressed") pcl::io::savePCDFileBinaryCompressed(pcdName, cloud);
+        else if (pcdFormat == "binary") pcl::io::savePCDFileBinary(pcdName, cloud);
+        else pcl::io::savePCDFileASCII(pcdName, cloud);
+        #endif
+
+        if (!scene.writeTruth(frame, folder + "truth/" + fileName + ".json")) {
+            cerr << "Could not write " << folder << "truth/" << fileName << ".json\n";
+            return 1;
+        }
+    }
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Wrote " << settings.frames << " frames to " << folder << " in " << elapsed << " s\n";
+    return 0;
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "config.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+//Back end is picked at build time from what the target always has: NEON on
+//the Jetson (aarch64) and SSE2 on any x86-64 machine, so no -m flags are
+//needed. Building with simd=false forces the scalar back end, which is the
+//reference the vector ones have to match.
+#if SIMD && defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define SIMD_NEON 1
+#elif SIMD && defined(__SSE2__)
+    #include <emmintrin.h>
+    #define SIMD_SSE2 1
+#else
+    #define SIMD_SCALAR 1
+#endif
+
+/* --- SIMD --- */
+/**
+\brief Four lane float and int vectors over NEON, SSE2 or plain arrays
+Only the operations the perception kernels use are here. loadBytes reads 16
+bytes as four int lanes in memory order, low byte first on both targets. Comparisons give a
+Mask with every bit of a lane set when true, which select() and bits() read.
+Rounding to int is to nearest even, like lrint, on every back end. What
+min, max and the int conversions give for NaN differs between back ends, so
+kernels select NaN lanes away first.
+*/
+namespace simd {
+
+static const int LANES = 4;
+
+#if SIMD_NEON
+
+struct F32 { float32x4_t v; };
+struct I32 { int32x4_t v; };
+struct Mask { uint32x4_t v; };
+
+inline F32 load(const float *p) { return {vld1q_f32(p)}; }
+inline I32 load(const int32_t *p) { return {vld1q_s32(p)}; }
+inline I32 loadBytes(const uint8_t *p) { return {vreinterpretq_s32_u8(vld1q_u8(p))}; }
+inline void store(float *p, F32 a) { vst1q_f32(p, a.v); }
+inline void store(int32_t *p, I32 a) { vst1q_s32(p, a.v); }
+inline F32 splat(float a) { return {vdupq_n_f32(a)}; }
+inline I32 splat(int32_t a) { return {vdupq_n_s32(a)}; }
+
+inline F32 operator+(F32 a, F32 b) { return {vaddq_f32(a.v, b.v)}; }
+inline F32 operator*(F32 a, F32 b) { return {vmulq_f32(a.v, b.v)}; }
+inline F32 min(F32 a, F32 b) { return {vminq_f32(a.v, b.v)}; }
+inline F32 max(F32 a, F32 b) { return {vmaxq_f32(a.v, b.v)}; }
+inline F32 abs(F32 a) { return {vabsq_f32(a.v)}; }
+
+inline Mask operator<(F32 a, F32 b) { return {vcltq_f32(a.v, b.v)}; }
+inline Mask operator<=(F32 a, F32 b) { return {vcleq_f32(a.v, b.v)}; }
+inline Mask operator>(F32 a, F32 b) { return {vcgtq_f32(a.v, b.v)}; }
+inline Mask operator>=(F32 a, F32 b) { return {vcgeq_f32(a.v, b.v)}; }
+inline Mask operator==(F32 a, F32 b) { return {vceqq_f32(a.v, b.v)}; }
+
+inline Mask operator&(Mask a, Mask b) { return {vandq_u32(a.v, b.v)}; }
+inline Mask operator|(Mask a, Mask b) { return {vorrq_u32(a.v, b.v)}; }
+inline Mask operator~(Mask a) { return {vmvnq_u32(a.v)}; }
+inline F32 select(Mask m, F32 a, F32 b) { return {vbslq_f32(m.v, a.v, b.v)}; }
+
+//Lane i of the mask as bit i
+inline int bits(Mask m) {
+    static const uint32_t weights[4] = {1, 2, 4, 8};
+    return (int)vaddvq_u32(vandq_u32(m.v, vld1q_u32(weights)));
+}
+
+inline I32 operator+(I32 a, I32 b) { return {vaddq_s32(a.v, b.v)}; }
+inline I32 operator-(I32 a, I32 b) { return {vsubq_s32(a.v, b.v)}; }
+inline I32 operator&(I32 a, I32 b) { return {vandq_s32(a.v, b.v)}; }
+template <int N> inline I32 shiftRight(I32 a) { return {vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a.v), N))}; }
+
+//True lanes as -1, so subtracting a mask counts the true lanes
+inline I32 toInt(Mask m) { return {vreinterpretq_s32_u32(m.v)}; }
+inline F32 toFloat(I32 a) { return {vcvtq_f32_s32(a.v)}; }
+inline I32 roundToInt(F32 a) { return {vcvtnq_s32_f32(a.v)}; }
+inline I32 truncToInt(F32 a) { return {vcvtq_s32_f32(a.v)}; }
+
+//Turns four xyzw points into x, y, z and w vectors
+inline void transpose(F32 &a, F32 &b, F32 &c, F32 &d) {
+    float32x4x2_t ab = vtrnq_f32(a.v, b.v);
+    float32x4x2_t cd = vtrnq_f32(c.v, d.v);
+    a.v = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b.v = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#elif SIMD_SSE2
+
+struct F32 { __m128 v; };
+struct I32 { __m128i v; };
+struct Mask { __m128 v; };
+
+inline F32 load(const float *p) { return {_mm_loadu_ps(p)}; }
+inline I32 load(const int32_t *p) { return {_mm_loadu_si128((const __m128i *)p)}; }
+inline I32 loadBytes(const uint8_t *p) { return {_mm_loadu_si128((const __m128i *)p)}; }
+inline void store(float *p, F32 a) { _mm_storeu_ps(p, a.v); }
+inline void store(int32_t *p, I32 a) { _mm_storeu_si128((__m128i *)p, a.v); }
+inline F32 splat(float a) { return {_mm_set1_ps(a)}; }
+inline I32 splat(int32_t a) { return {_mm_set1_epi32(a)}; }
+
+inline F32 operator+(F32 a, F32 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline F32 operator*(F32 a, F32 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline F32 min(F32 a, F32 b) { return {_mm_min_ps(a.v, b.v)}; }
+inline F32 max(F32 a, F32 b) { return {_mm_max_ps(a.v, b.v)}; }
+inline F32 abs(F32 a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+
+inline Mask operator<(F32 a, F32 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline Mask operator<=(F32 a, F32 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+inline Mask operator>(F32 a, F32 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline Mask operator>=(F32 a, F32 b) { return {_mm_cmpge_ps(a.v, b.v)}; }
+inline Mask operator==(F32 a, F32 b) { return {_mm_cmpeq_ps(a.v, b.v)}; }
+
+inline Mask operator&(Mask a, Mask b) { return {_mm_and_ps(a.v, b.v)}; }
+inline Mask operator|(Mask a, Mask b) { return {_mm_or_ps(a.v, b.v)}; }
+inline Mask operator~(Mask a) { return {_mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1)))}; }
+inline F32 select(Mask m, F32 a, F32 b) { return {_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v))}; }
+
+//Lane i of the mask as bit i
+inline int bits(Mask m) { return _mm_movemask_ps(m.v); }
+
+inline I32 operator+(I32 a, I32 b) { return {_mm_add_epi32(a.v, b.v)}; }
+inline I32 operator-(I32 a, I32 b) { return {_mm_sub_epi32(a.v, b.v)}; }
+inline I32 operator&(I32 a, I32 b) { return {_mm_and_si128(a.v, b.v)}; }
+template <int N> inline I32 shiftRight(I32 a) { return {_mm_srli_epi32(a.v, N)}; }
+
+//True lanes as -1, so subtracting a mask counts the true lanes
+inline I32 toInt(Mask m) { return {_mm_castps_si128(m.v)}; }
+inline F32 toFloat(I32 a) { return {_mm_cvtepi32_ps(a.v)}; }
+//Uses the MXCSR rounding mode, which is left at nearest even
+inline I32 roundToInt(F32 a) { return {_mm_cvtps_epi32(a.v)}; }
+inline I32 truncToInt(F32 a) { return {_mm_cvttps_epi32(a.v)}; }
+
+//Turns four xyzw points into x, y, z and w vectors
+inline void transpose(F32 &a, F32 &b, F32 &c, F32 &d) {
+    _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+}
+
+#else
+
+struct F32 { float v[4]; };
+struct I32 { int32_t v[4]; };
+struct Mask { uint32_t v[4]; };
+
+#define SIMD_LANEWISE(result, expr) { result out; for (int i = 0; i < 4; ++i) out.v[i] = (expr); return out; }
+
+inline F32 load(const float *p) { F32 a; std::memcpy(a.v, p, sizeof(a.v)); return a; }
+inline I32 load(const int32_t *p) { I32 a; std::memcpy(a.v, p, sizeof(a.v)); return a; }
+inline I32 loadBytes(const uint8_t *p) { I32 a; std::memcpy(a.v, p, sizeof(a.v)); return a; }
+inline void store(float *p, F32 a) { std::memcpy(p, a.v, sizeof(a.v)); }
+inline void store(int32_t *p, I32 a) { std::memcpy(p, a.v, sizeof(a.v)); }
+inline F32 splat(float a) SIMD_LANEWISE(F32, a)
+inline I32 splat(int32_t a) SIMD_LANEWISE(I32, a)
+
+inline F32 operator+(F32 a, F32 b) SIMD_LANEWISE(F32, a.v[i] + b.v[i])
+inline F32 operator*(F32 a, F32 b) SIMD_LANEWISE(F32, a.v[i] * b.v[i])
+inline F32 min(F32 a, F32 b) SIMD_LANEWISE(F32, a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+inline F32 max(F32 a, F32 b) SIMD_LANEWISE(F32, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+inline F32 abs(F32 a) SIMD_LANEWISE(F32, std::fabs(a.v[i]))
+
+inline Mask operator<(F32 a, F32 b) SIMD_LANEWISE(Mask, a.v[i] < b.v[i] ? ~0u : 0u)
+inline Mask operator<=(F32 a, F32 b) SIMD_LANEWISE(Mask, a.v[i] <= b.v[i] ? ~0u : 0u)
+inline Mask operator>(F32 a, F32 b) SIMD_LANEWISE(Mask, a.v[i] > b.v[i] ? ~0u : 0u)
+inline Mask operator>=(F32 a, F32 b) SIMD_LANEWISE(Mask, a.v[i] >= b.v[i] ? ~0u : 0u)
+inline Mask operator==(F32 a, F32 b) SIMD_LANEWISE(Mask, a.v[i] == b.v[i] ? ~0u : 0u)
+
+inline Mask operator&(Mask a, Mask b) SIMD_LANEWISE(Mask, a.v[i] & b.v[i])
+inline Mask operator|(Mask a, Mask b) SIMD_LANEWISE(Mask, a.v[i] | b.v[i])
+inline Mask operator~(Mask a) SIMD_LANEWISE(Mask, ~a.v[i])
+inline F32 select(Mask m, F32 a, F32 b) SIMD_LANEWISE(F32, m.v[i] ? a.v[i] : b.v[i])
+
+//Lane i of the mask as bit i
+inline int bits(Mask m) {
+    int out = 0;
+    for (int i = 0; i < 4; ++i) out |= (m.v[i] & 1) << i;
+    return out;
+}
+
+inline I32 operator+(I32 a, I32 b) SIMD_LANEWISE(I32, (int32_t)((uint32_t)a.v[i] + (uint32_t)b.v[i]))
+inline I32 operator-(I32 a, I32 b) SIMD_LANEWISE(I32, (int32_t)((uint32_t)a.v[i] - (uint32_t)b.v[i]))
+inline I32 operator&(I32 a, I32 b) SIMD_LANEWISE(I32, a.v[i] & b.v[i])
+template <int N> inline I32 shiftRight(I32 a) SIMD_LANEWISE(I32, (int32_t)((uint32_t)a.v[i] >> N))
+
+//True lanes as -1, so subtracting a mask counts the true lanes
+inline I32 toInt(Mask m) SIMD_LANEWISE(I32, (int32_t)m.v[i])
+inline F32 toFloat(I32 a) SIMD_LANEWISE(F32, (float)a.v[i])
+inline I32 roundToInt(F32 a) SIMD_LANEWISE(I32, (int32_t)std::lrint(a.v[i]))
+inline I32 truncToInt(F32 a) SIMD_LANEWISE(I32, (int32_t)a.v[i])
+
+//Turns four xyzw points into x, y, z and w vectors
+inline void transpose(F32 &a, F32 &b, F32 &c, F32 &d) {
+    F32 rows[4] = {a, b, c, d};
+    for (int i = 0; i < 4; ++i) {
+        a.v[i] = rows[i].v[0];
+        b.v[i] = rows[i].v[1];
+        c.v[i] = rows[i].v[2];
+        d.v[i] = rows[i].v[3];
+    }
+}
+
+#undef SIMD_LANEWISE
+
+#endif
+
+} //namespace simd
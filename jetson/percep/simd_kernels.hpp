@@ -0,0 +1,172 @@
+#pragma once
+
+#include "simd.hpp"
+#include "compact_cloud.hpp"
+#include "rapidjson/document.h"
+#include <cfloat>
+
+//The vectorized loops perception runs every frame. Each one has a scalar
+//helper for a single element that its tail loop uses, which is also what
+//percep_test/simd_test.cpp checks the whole vector loop against.
+
+/* --- Pass Through Bounds --- */
+//Depth (z) and height (y) limits applied while the cloud is being packed
+//Values are in mm and are inclusive, matching pcl::PassThrough
+struct PassThroughBounds {
+    float low;
+    float upperZ;
+    float upperY;
+
+    PassThroughBounds(float low, float upperZ, float upperY) :
+        low{low}, upperZ{upperZ}, upperY{upperY} {}
+
+    PassThroughBounds(const rapidjson::Document &config) :
+        low{config["pt_cloud"]["pass_through"]["lower_bd"].GetFloat()},
+        upperZ{config["pt_cloud"]["pass_through"]["upper_bd_z"].GetFloat()},
+        upperY{config["pt_cloud"]["pass_through"]["upper_bd_y"].GetFloat()} {}
+
+    //NaN and +/-inf fail every comparison so invalid measures are rejected here too
+    //A point at the origin is how invalid measures are stored in recorded .pcd files
+    inline bool keep(float x, float y, float z) const {
+        return z >= low && z <= upperZ && y >= low && y <= upperY &&
+               std::isfinite(x) && (x != 0.0f || y != 0.0f || z != 0.0f);
+    }
+};
+
+/* --- Crop And Pack --- */
+//Converts a ZED XYZRGBA buffer into a compact cloud in a single pass
+//Invalid points and points outside the pass through bounds are dropped, and
+//color is too since obstacle detection never reads it
+//Four points are tested and rounded at once, then written unconditionally with
+//the write index only advancing on kept points, which keeps the loop free of branches
+inline void cropAndPack(const float * __restrict xyzrgba, size_t numPoints, const PassThroughBounds &bounds,
+                        CompactCloud &cloud) {
+    cloud.resize(numPoints);
+    int16_t * __restrict outX = cloud.x.data();
+    int16_t * __restrict outY = cloud.y.data();
+    int16_t * __restrict outZ = cloud.z.data();
+    size_t kept = 0;
+
+    const simd::F32 low = simd::splat(bounds.low);
+    const simd::F32 upperZ = simd::splat(bounds.upperZ);
+    const simd::F32 upperY = simd::splat(bounds.upperY);
+    const simd::F32 zero = simd::splat(0.0f);
+    const simd::F32 largest = simd::splat(FLT_MAX);
+    const simd::F32 int16Low = simd::splat(-32768.0f);
+    const simd::F32 int16High = simd::splat(32767.0f);
+    int32_t xs[simd::LANES], ys[simd::LANES], zs[simd::LANES];
+
+    size_t i = 0;
+    for (; i + simd::LANES <= numPoints; i += simd::LANES, xyzrgba += 4 * simd::LANES) {
+        simd::F32 x = simd::load(xyzrgba);
+        simd::F32 y = simd::load(xyzrgba + 4);
+        simd::F32 z = simd::load(xyzrgba + 8);
+        simd::F32 rgba = simd::load(xyzrgba + 12);
+        simd::transpose(x, y, z, rgba);
+
+        //Same test as PassThroughBounds::keep, NaN fails every comparison
+        simd::Mask keep = (z >= low) & (z <= upperZ) & (y >= low) & (y <= upperY) &
+                          (simd::abs(x) <= largest) & ~((x == zero) & (y == zero) & (z == zero));
+
+        //Dropped points are zeroed so invalid measures never reach the rounding
+        simd::store(xs, simd::roundToInt(simd::min(simd::max(simd::select(keep, x, zero), int16Low), int16High)));
+        simd::store(ys, simd::roundToInt(simd::min(simd::max(simd::select(keep, y, zero), int16Low), int16High)));
+        simd::store(zs, simd::roundToInt(simd::min(simd::max(simd::select(keep, z, zero), int16Low), int16High)));
+
+        int keepBits = simd::bits(keep);
+        for (int lane = 0; lane < simd::LANES; ++lane) {
+            outX[kept] = (int16_t)xs[lane];
+            outY[kept] = (int16_t)ys[lane];
+            outZ[kept] = (int16_t)zs[lane];
+            kept += (keepBits >> lane) & 1;
+        }
+    }
+
+    for (; i < numPoints; ++i, xyzrgba += 4) {
+        float x = xyzrgba[0];
+        float y = xyzrgba[1];
+        float z = xyzrgba[2];
+        bool keep = bounds.keep(x, y, z);
+        outX[kept] = keep ? toCompact(x) : 0;
+        outY[kept] = keep ? toCompact(y) : 0;
+        outZ[kept] = keep ? toCompact(z) : 0;
+        kept += keep;
+    }
+
+    cloud.resize(kept);
+}
+
+/* --- Depth Row Sweep --- */
+//What makes a depth pixel an obstacle, see DepthObstacleDetector::reduceColumns
+//A pixel at depth z in a row with factor k sits z * k below the camera
+struct DepthObstacleBounds {
+    float maxRange;
+    float lowestDrop;
+    float highestDrop;
+
+    //NaN and inf fail these compares, so invalid measures never count
+    inline bool isObstacle(float z, float k) const {
+        const float drop = z * k;
+        return (z > 0.0f) & (z < maxRange) & (drop >= lowestDrop) & (drop <= highestDrop);
+    }
+};
+
+//Counts the obstacle pixels of one depth row into hits and keeps the
+//nearest of them per column in nearest, four columns at a time
+inline void sweepDepthRow(const float * __restrict row, int cols, float k, const DepthObstacleBounds &bounds,
+                          float * __restrict nearest, int * __restrict hits) {
+    const simd::F32 zero = simd::splat(0.0f);
+    const simd::F32 rangeLimit = simd::splat(bounds.maxRange);
+    const simd::F32 dropLow = simd::splat(bounds.lowestDrop);
+    const simd::F32 dropHigh = simd::splat(bounds.highestDrop);
+    const simd::F32 rowK = simd::splat(k);
+
+    int c = 0;
+    for (; c + simd::LANES <= cols; c += simd::LANES) {
+        const simd::F32 z = simd::load(row + c);
+        const simd::F32 drop = z * rowK;
+        const simd::Mask obstacle = (z > zero) & (z < rangeLimit) & (drop >= dropLow) & (drop <= dropHigh);
+        simd::store(hits + c, simd::load(hits + c) - simd::toInt(obstacle));
+        const simd::F32 current = simd::load(nearest + c);
+        simd::store(nearest + c, simd::select(obstacle & (z < current), z, current));
+    }
+
+    for (; c < cols; ++c) {
+        const float z = row[c];
+        const bool obstacle = bounds.isObstacle(z, k);
+        hits[c] += obstacle;
+        nearest[c] = (obstacle && z < nearest[c]) ? z : nearest[c];
+    }
+}
+
+/* --- BGRA To Gray --- */
+//Same fixed point weights as OpenCV's BGRA2GRAY
+inline uint8_t grayOf(uint8_t b, uint8_t g, uint8_t r) {
+    return (uint8_t)((b * 1868 + g * 9617 + r * 4899 + 8192) >> 14);
+}
+
+//The sum stays under 2^24, so it is exact in float and four pixels are weighed at once
+inline void bgraToGray(const uint8_t * __restrict bgra, uint8_t * __restrict gray, size_t numPixels) {
+    const simd::I32 byteMask = simd::splat((int32_t)0xFF);
+    const simd::F32 blueWeight = simd::splat(1868.0f);
+    const simd::F32 greenWeight = simd::splat(9617.0f);
+    const simd::F32 redWeight = simd::splat(4899.0f);
+    const simd::F32 half = simd::splat(8192.0f);
+    const simd::F32 scale = simd::splat(1.0f / 16384);
+    int32_t luma[simd::LANES];
+
+    size_t i = 0;
+    for (; i + simd::LANES <= numPixels; i += simd::LANES, bgra += 4 * simd::LANES) {
+        //One pixel per lane, blue in the low byte
+        simd::I32 px = simd::loadBytes(bgra);
+        simd::F32 b = simd::toFloat(px & byteMask);
+        simd::F32 g = simd::toFloat(simd::shiftRight<8>(px) & byteMask);
+        simd::F32 r = simd::toFloat(simd::shiftRight<16>(px) & byteMask);
+        simd::store(luma, simd::truncToInt((b * blueWeight + g * greenWeight + r * redWeight + half) * scale));
+        for (int lane = 0; lane < simd::LANES; ++lane) gray[i + lane] = (uint8_t)luma[lane];
+    }
+
+    for (; i < numPixels; ++i, bgra += 4) {
+        gray[i] = grayOf(bgra[0], bgra[1], bgra[2]);
+    }
+}
@@ -0,0 +1,95 @@
+#include "telemetry.hpp"
+#include <cmath>
+
+static const char *STAGE_NAMES[(int)Stage::NumStages] = {
+    "grab",
+    "ar_detection",
+    "ar_frame_age",
+    "voxel_filter",
+    "ground_plane",
+    "clustering",
+    "clear_path",
+    "obstacle_detection",
+    "obstacle_frame_age"
+};
+
+LatencyHistogram::LatencyHistogram() : maxMicros(0) {
+    for (auto &bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+}
+
+//Bucket is the octave of micros times SUB_BUCKETS plus the next two bits below the top bit
+int LatencyHistogram::bucketOf(uint64_t micros) {
+    if (micros < 2) return (int)micros * SUB_BUCKETS / 2;
+    int octave = 63 - __builtin_clzll(micros);
+    int sub = (int)((micros >> (octave - 1)) & 1) * 2 + (octave >= 2 ? (int)((micros >> (octave - 2)) & 1) : 0);
+    int bucket = octave * SUB_BUCKETS + sub;
+    return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+double LatencyHistogram::bucketUpperMs(int bucket) {
+    int octave = bucket / SUB_BUCKETS;
+    int sub = bucket % SUB_BUCKETS;
+    return std::ldexp(1.0 + (sub + 1.0) / SUB_BUCKETS, octave) / 1000.0;
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration latency) {
+    uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t prevMax = maxMicros.load(std::memory_order_relaxed);
+    while (micros > prevMax && !maxMicros.compare_exchange_weak(prevMax, micros, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::snapshotAndReset(rover_msgs::StageLatency &out) {
+    uint32_t counts[NUM_BUCKETS];
+    uint64_t total = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        counts[i] = buckets[i].exchange(0, std::memory_order_relaxed);
+        total += counts[i];
+    }
+    uint64_t max = maxMicros.exchange(0, std::memory_order_relaxed);
+
+    out.count = total;
+    out.p50_ms = out.p95_ms = out.p99_ms = 0;
+    out.max_ms = max / 1000.0;
+    if (!total) return;
+
+    //Walk the buckets once, filling each percentile as its rank is passed
+    double *percentiles[3] = { &out.p50_ms, &out.p95_ms, &out.p99_ms };
+    const double fractions[3] = { 0.50, 0.95, 0.99 };
+    int next = 0;
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS && next < 3; ++i) {
+        seen += counts[i];
+        while (next < 3 && seen >= std::ceil(fractions[next] * total)) {
+            //A bucket's upper bound can overshoot the largest sample in it
+            *percentiles[next] = std::min(bucketUpperMs(i), out.max_ms);
+            ++next;
+        }
+    }
+}
+
+LatencyHistogram &Telemetry::operator[](Stage stage) {
+    return histograms[(int)stage];
+}
+
+void Telemetry::snapshotAndReset(rover_msgs::PerceptionLatency &out) {
+    out.num_stages = (int)Stage::NumStages;
+    out.stages.resize(out.num_stages);
+    for (int i = 0; i < out.num_stages; ++i) {
+        out.stages[i].name = STAGE_NAMES[i];
+        histograms[i].snapshotAndReset(out.stages[i]);
+    }
+}
+
+void Telemetry::publish(lcm::LCM &lcm, const std::string &channel, int64_t framesDropped) {
+    rover_msgs::PerceptionLatency message;
+    snapshotAndReset(message);
+    message.frames_dropped = framesDropped;
+    lcm.publish(channel, &message);
+}
+
+Telemetry &telemetry() {
+    static Telemetry instance;
+    return instance;
+}
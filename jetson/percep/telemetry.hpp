@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <lcm/lcm-cpp.hpp>
+#include "rover_msgs/PerceptionLatency.hpp"
+
+/* --- Latency Histogram --- */
+/**
+\brief Lock-free log scale histogram of stage latencies
+Buckets split every power of two microseconds into SUB_BUCKETS steps, so
+percentiles are accurate to within about 20%. Recording is a couple of
+relaxed atomic adds and is safe from any thread.
+*/
+class LatencyHistogram {
+    public:
+        static const int SUB_BUCKETS = 4;
+        static const int OCTAVES = 27; //1 us to ~2 minutes
+        static const int NUM_BUCKETS = SUB_BUCKETS * OCTAVES;
+
+        LatencyHistogram();
+
+        //Adds one sample
+        void record(std::chrono::steady_clock::duration latency);
+
+        //Fills out with the percentiles since the last snapshot and clears the histogram
+        void snapshotAndReset(rover_msgs::StageLatency &out);
+
+    private:
+        static int bucketOf(uint64_t micros);
+        static double bucketUpperMs(int bucket);
+
+        std::atomic<uint32_t> buckets[NUM_BUCKETS];
+        std::atomic<uint64_t> maxMicros;
+};
+
+/* --- Telemetry --- */
+//Perception stages that are timed every frame
+enum class Stage {
+    Grab,
+    ARDetection,
+    ARFrameAge,
+    VoxelFilter,
+    GroundPlane,
+    Clustering,
+    ClearPath,
+    ObstacleDetection,
+    ObstacleFrameAge,
+    NumStages
+};
+
+class Telemetry {
+    public:
+        //Histogram of one stage
+        LatencyHistogram &operator[](Stage stage);
+
+        //Fills out with every stage's percentiles since the last snapshot and clears them
+        void snapshotAndReset(rover_msgs::PerceptionLatency &out);
+
+        //Publishes every stage's percentiles since the last publish
+        void publish(lcm::LCM &lcm, const std::string &channel, int64_t framesDropped);
+
+    private:
+        LatencyHistogram histograms[(int)Stage::NumStages];
+};
+
+//Process wide telemetry shared by every stage
+Telemetry &telemetry();
+
+/* --- Latency Probe --- */
+//Records the time from construction to destruction into a stage's histogram
+class LatencyProbe {
+    public:
+        LatencyProbe(Stage stage) : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+
+        ~LatencyProbe() {
+            telemetry()[stage_].record(std::chrono::steady_clock::now() - start_);
+        }
+
+    private:
+        Stage stage_;
+        std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,115 @@
+#include "rover_msgs/PerceptionDebugCloud.hpp"
+#include <lcm/lcm-cpp.hpp>
+#include <pcl/point_types.h>
+#include <pcl/visualization/pcl_visualizer.h>
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+/* --- Perception Debug Viewer --- */
+//Shows the obstacle cloud perception streams over LCM with DebugCloudStream.
+//Runs anywhere on the rover's LCM network, so the viewer's rendering never
+//shows up in perception's timing.
+
+static const char *DEFAULT_CHANNEL = "/perception_debug_cloud";
+static const double PI = 3.14159265;
+
+class DebugViewer {
+    public:
+        DebugViewer() : viewer("PCL ZED 3D Viewer"), cloud(new pcl::PointCloud<pcl::PointXYZRGB>) {
+            viewer.setBackgroundColor(0.12, 0.12, 0.12);
+            pcl::visualization::PointCloudColorHandlerRGBField<pcl::PointXYZRGB> rgb(cloud);
+            viewer.addPointCloud<pcl::PointXYZRGB>(cloud, rgb);
+            viewer.setPointCloudRenderingProperties(pcl::visualization::PCL_VISUALIZER_POINT_SIZE, 1.5);
+            viewer.addCoordinateSystem(1.0);
+            viewer.initCameraParameters();
+            viewer.setCameraPosition(0, 0, -800, 0, -1, 0);
+        }
+
+        void onCloud(const lcm::ReceiveBuffer*, const string&, const rover_msgs::PerceptionDebugCloud *msg) {
+            cloud->points.resize(msg->num_points);
+            for (int i = 0; i < msg->num_points; ++i) {
+                pcl::PointXYZRGB &pt = cloud->points[i];
+                pt.x = msg->x[i] * msg->quantization_mm;
+                pt.y = msg->y[i] * msg->quantization_mm;
+                pt.z = msg->z[i] * msg->quantization_mm;
+                color(pt, msg->cluster[i], msg->half_rover_mm);
+            }
+            cloud->width = msg->num_points;
+            cloud->height = 1;
+            viewer.updatePointCloud(cloud);
+
+            bool centerClear = msg->distance < 0;
+            drawPath(0, msg->half_rover_mm, "center", centerClear);
+            drawPath(msg->left_bearing, msg->half_rover_mm, "left", true);
+            drawPath(msg->right_bearing, msg->half_rover_mm, "right", true);
+        }
+
+        bool stopped() {
+            return viewer.wasStopped();
+        }
+
+        void spinOnce() {
+            viewer.spinOnce(10);
+        }
+
+    private:
+        //Clustered points in the rover's path are orange, other clusters cycle
+        //through shades of red, green and blue, unclustered points are gray
+        static void color(pcl::PointXYZRGB &pt, int cluster, int halfRover) {
+            pt.r = pt.g = pt.b = 0;
+            if (cluster < 0) {
+                pt.r = pt.g = pt.b = 120;
+            }
+            else if (pt.x >= -halfRover && pt.x <= halfRover) {
+                pt.r = 255;
+                pt.g = 69;
+            }
+            else {
+                uint8_t shade = 100 + (cluster * 15) % 156;
+                if (cluster % 3) pt.r = shade;
+                else if (cluster % 2) pt.g = shade;
+                else pt.b = shade;
+            }
+        }
+
+        //Projects the edges of the rover corridor at bearing out to 7 m
+        //Green if the corridor is clear, red if it is blocked
+        void drawPath(double bearing, int halfRover, const string &id, bool clear) {
+            double offset = 7000 * tan(bearing * PI / 180);
+            pcl::PointXYZRGB pt1, pt2, pt3, pt4;
+            pt1.x = -halfRover; pt1.y = 0; pt1.z = 0;
+            pt2.x = halfRover; pt2.y = 0; pt2.z = 0;
+            pt3.x = -halfRover + offset; pt3.y = 0; pt3.z = 7000;
+            pt4.x = halfRover + offset; pt4.y = 0; pt4.z = 7000;
+
+            viewer.removeShape(id + "l1");
+            viewer.removeShape(id + "l2");
+            viewer.addLine(pt1, pt3, clear ? 0 : 255, clear ? 255 : 0, 0, id + "l1");
+            viewer.addLine(pt2, pt4, clear ? 0 : 255, clear ? 255 : 0, 0, id + "l2");
+        }
+
+        pcl::visualization::PCLVisualizer viewer;
+        pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud;
+};
+
+int main(int argc, char **argv) {
+    string channel = argc > 1 ? argv[1] : DEFAULT_CHANNEL;
+
+    lcm::LCM lcm_;
+    if (!lcm_.good()) {
+        cerr << "Could not start LCM\n";
+        return 1;
+    }
+
+    DebugViewer viewer;
+    lcm_.subscribe(channel, &DebugViewer::onCloud, &viewer);
+
+    //Messages are handled on this thread between renders, VTK isn't thread safe
+    while (!viewer.stopped()) {
+        lcm_.handleTimeout(10);
+        viewer.spinOnce();
+    }
+    return 0;
+}